@@ -9,6 +9,7 @@ arg_parser.add_argument('-bp', '--boost_path')
 arg_parser.add_argument('-g', '--generator')
 arg_parser.add_argument('-j', '--jobs', action='store_true')
 arg_parser.add_argument('-nsi', '--no-string-interning', action='store_true')
+arg_parser.add_argument('-nb', '--nan-boxing', action='store_true')
 
 if __name__ == '__main__':
     if not os.path.isdir('build'):
@@ -20,6 +21,7 @@ if __name__ == '__main__':
     boost_path = args.boost_path
     generator = args.generator
     no_string_interning = args.no_string_interning
+    nan_boxing = args.nan_boxing
 
     if config:
         if config not in ['Debug', 'Release']:
@@ -36,11 +38,14 @@ if __name__ == '__main__':
     if boost_path:
         command += f' -DPOISE_BOOST_PATH={boost_path}'
 
-    if no_string_interning:
+    if no_string_interning or nan_boxing:
         command += ' -DPOISE_INTERN_STRINGS=OFF'
     else:
         command += ' -DPOISE_INTERN_STRINGS=ON'
 
+    if nan_boxing:
+        command += ' -DPOISE_NAN_BOXING=ON'
+
     ret_code = os.system(command)
 
     if ret_code == 0:
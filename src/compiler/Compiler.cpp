@@ -1,9 +1,12 @@
 #include "Compiler.hpp"
+#include "../objects/Struct.hpp"
 #include "../runtime/memory/StringInterner.hpp"
 
 #include <fmt/color.h>
 #include <fmt/core.h>
 
+#include <bit>
+
 namespace poise::compiler {
 Compiler::Compiler(bool mainFile, bool stdFile, runtime::Vm* vm, std::filesystem::path inFilePath)
     : m_mainFile{mainFile}
@@ -52,24 +55,76 @@ auto Compiler::compile() -> CompileResult
 
     if (m_mainFile) {
         if (m_mainFunction) {
-            emitConstant(m_filePathHash);
-            emitConstant(runtime::memory::internString("main"));
-            emitOp(runtime::Op::LoadFunctionOrStruct, 0_uz);
-            emitConstant(0);
-            emitConstant(false);
-            emitConstant(false);
-            emitOp(runtime::Op::Call, 0_uz);
+            emitDirectCall(m_filePathHash, runtime::memory::internString("main"), {.numArgs = 0_u8, .hasUnpack = false}, 0_uz, 0_uz);
             emitOp(runtime::Op::Pop, 0_uz);
             emitOp(runtime::Op::Exit, scanner::Scanner::getNumLines(m_filePath));
         } else {
             errorAtPrevious("No main function declared");
             return CompileResult::CompileError;
         }
+
+        // every namespace has been compiled by now
+        if (!link()) {
+            return CompileResult::CompileError;
+        }
     }
 
     return CompileResult::Success;
 }
 
+auto Compiler::link() const -> bool
+{
+    const auto namespaceManager = m_vm->namespaceManager();
+    auto linked = true;
+
+    for (const auto& linkSite : m_vm->linkSites()) {
+        const auto& name = runtime::memory::findInternedString(linkSite.nameHash);
+        const auto namespaceName = namespaceManager->namespaceDisplayName(linkSite.namespaceHash);
+        const auto sameNamespace = linkSite.namespaceHash == linkSite.callerNamespaceHash;
+
+        if (const auto function = namespaceManager->namespaceFunction(linkSite.namespaceHash, linkSite.nameHash)) {
+            const auto functionPtr = function->object()->asFunction();
+            if (!sameNamespace && !functionPtr->exported()) {
+                linkError(linkSite, fmt::format("Function '{}' in namespace '{}' is not exported", name, namespaceName));
+                linked = false;
+                continue;
+            }
+
+            if (linkSite.kind == runtime::Vm::LinkSite::Kind::Load) {
+                linkSite.chunk->patchOperand(linkSite.index + 1_uz, std::bit_cast<usize>(function->object()));
+                continue;
+            }
+
+            // operands are the number of args, whether there was an unpack, whether the args have been checked, and the function
+            // with an unpack the number of args is only known at run time
+            const auto numArgs = linkSite.chunk->operandAt<u8>(linkSite.index + 1_uz);
+            const auto hasUnpack = linkSite.chunk->operandAt<bool>(linkSite.index + 2_uz);
+            const auto argsChecked = !hasUnpack && (functionPtr->hasVariadicParams() ? numArgs >= functionPtr->arity() : numArgs == functionPtr->arity());
+            linkSite.chunk->patchOperand(linkSite.index + 3_uz, argsChecked);
+            linkSite.chunk->patchOperand(linkSite.index + 4_uz, std::bit_cast<usize>(functionPtr));
+        } else if (const auto structure = namespaceManager->namespaceStruct(linkSite.namespaceHash, linkSite.nameHash)) {
+            if (!sameNamespace && !structure->object()->asStruct()->exported()) {
+                linkError(linkSite, fmt::format("Struct '{}' in namespace '{}' is not exported", name, namespaceName));
+                linked = false;
+                continue;
+            }
+
+            if (linkSite.kind == runtime::Vm::LinkSite::Kind::Call) {
+                linkError(linkSite, fmt::format("Struct '{}' is not callable", name));
+                linked = false;
+                continue;
+            }
+
+            linkSite.chunk->patchOperand(linkSite.index + 1_uz, std::bit_cast<usize>(structure->object()));
+        } else {
+            linkError(linkSite, fmt::format("No function or struct named '{}' in namespace '{}'", name, namespaceName));
+            linked = false;
+        }
+    }
+
+    return linked;
+}
+
 auto Compiler::errorAtCurrent(std::string_view message) -> void
 {
     error(*m_current, message);
@@ -119,4 +174,14 @@ auto Compiler::error(const scanner::Token& token, std::string_view message) -> v
 
     fmt::print(stderr, "        |\n");
 }
+
+auto Compiler::linkError(const runtime::Vm::LinkSite& linkSite, std::string_view message) const -> void
+{
+    fmt::print(stderr, fmt::emphasis::bold | fmt::fg(fmt::color::red), "Link Error");
+    fmt::print(stderr, ": {}\n", message);
+    fmt::print(stderr, "       --> {}:{}\n", linkSite.callerFilePath.string(), linkSite.line);
+    fmt::print(stderr, "        |\n");
+    fmt::print(stderr, "{:>7} | {}\n", linkSite.line, scanner::Scanner::getCodeAtLine(linkSite.callerFilePath, linkSite.line));
+    fmt::print(stderr, "        |\n");
+}
 }   // namespace poise::compiler
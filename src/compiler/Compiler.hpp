@@ -26,27 +26,42 @@ public:
     [[nodiscard]] auto compile() -> CompileResult;
 
 private:
+    // resolves every function and struct referenced by name now that every namespace has been compiled,
+    // so the vm never has to look anything up by name, returns false if any reference couldn't be resolved
+    [[nodiscard]] auto link() const -> bool;
+    auto linkError(const runtime::Vm::LinkSite& linkSite, std::string_view message) const -> void;
+
     enum class Context
     {
-        Catch, ForLoop, Function, IfStatement, Lambda, TopLevel, Try, WhileLoop,
+        Catch, ForLoop, ForRangeLoop, Function, IfStatement, Lambda, TopLevel, Try, WhileLoop,
     };
 
     auto emitOp(runtime::Op op, usize line) const noexcept -> void;
-    auto emitConstant(runtime::Value value) const noexcept -> void;
 
-    struct JumpIndexes
+    template<runtime::Operand T>
+    auto emitOperand(T operand) const noexcept -> void
     {
-        usize constantIndex, opIndex;
-    };
+        m_vm->currentChunk()->emitOperand(operand);
+    }
+
+    [[nodiscard]] auto makeConstant(runtime::Value value) const noexcept -> u32;
+    auto emitConstant(runtime::Value value, usize line) const noexcept -> void;
+
+    // offset of a jump target operand in the current chunk, waiting to be patched
+    using JumpOffset = usize;
 
     enum class JumpType
     {
         IfFalse, IfTrue, Jump
     };
 
-    [[nodiscard]] auto emitJump() const noexcept -> JumpIndexes;
-    [[nodiscard]] auto emitJump(JumpType jumpType, bool emitPop) const noexcept -> JumpIndexes;
-    auto patchJump(JumpIndexes jumpIndexes) const noexcept -> void;
+    [[nodiscard]] auto emitJump() const noexcept -> JumpOffset;
+    [[nodiscard]] auto emitJump(JumpType jumpType, bool emitPop) const noexcept -> JumpOffset;
+    [[nodiscard]] auto emitJumpOperand() const noexcept -> JumpOffset;
+    auto emitJumpTo(usize target) const noexcept -> void;
+    auto patchJump(JumpOffset jumpOffset) const noexcept -> void;
+    [[nodiscard]] auto currentOffset() const noexcept -> usize;
+    [[nodiscard]] auto markJumpTarget() const noexcept -> usize;
 
     auto advance() -> void;
     [[nodiscard]] auto match(scanner::TokenType expected) -> bool;
@@ -61,9 +76,12 @@ private:
     [[nodiscard]] auto hasLocal(std::string_view localName) const noexcept -> bool;
     [[nodiscard]] auto findLocal(std::string_view localName) const noexcept -> std::optional<LocalVariable>;
     [[nodiscard]] auto indexOfLocal(std::string_view localName) const noexcept -> std::optional<usize>;
+    [[nodiscard]] auto indexOfUpvalue(std::string_view upvalueName) const noexcept -> std::optional<usize>;
 
     [[nodiscard]] auto checkLastOp(runtime::Op op) const noexcept -> bool;
     [[nodiscard]] auto lastOpWasAssignment() const noexcept -> bool;
+    // if the value about to be returned comes straight from a call, turns the call into a tail call
+    auto convertTailCall() const noexcept -> void;
 
     struct CallArgsParseResult
     {
@@ -117,6 +135,8 @@ private:
     auto ifStatement() -> void;
     auto whileStatement() -> void;
     auto forStatement() -> void;
+    // the rest of a for loop over a range literal, once its start and `..` have been compiled
+    auto forRangeLoop(usize iteratorLocalIndex, bool inclusive) -> void;
     auto breakStatement() -> void;
     auto continueStatement() -> void;
 
@@ -155,6 +175,10 @@ private:
     auto identifier(bool canAssign) -> void;
     auto nativeCall() -> void;
     auto namespaceQualifiedCall() -> void;
+    auto loadFunctionOrStruct(usize namespaceHash, usize nameHash) -> void;
+    // parses the args of a call to a function named at compile time and emits a CallDirect for it
+    auto directCall(usize namespaceHash, usize functionNameHash) -> void;
+    auto emitDirectCall(usize namespaceHash, usize functionNameHash, CallArgsParseResult args, usize nameLine, usize line) const noexcept -> void;
 
     auto typeIdent() -> void;
     auto typeOf() -> void;
@@ -163,6 +187,12 @@ private:
     auto tupleOrGrouping() -> void;
     auto dict() -> void;
 
+    // register mode, folding the loads of a binary op's operands into a three-address op
+    auto emitBinaryOp(runtime::Op op, usize line) -> void;
+    [[nodiscard]] auto takeRegisterOperand() -> std::optional<u32>;
+    [[nodiscard]] auto takeRegisterOperands() -> std::optional<std::tuple<u32, u32>>;
+    [[nodiscard]] auto retargetRegisterOp(u32 localIndex) -> bool;
+
     [[nodiscard]] auto parseString() -> std::optional<std::string>;
     [[nodiscard]] auto parseInt() -> std::optional<i64>;
     [[nodiscard]] auto parseFloat() -> std::optional<f64>;
@@ -189,9 +219,11 @@ private:
     std::optional<scanner::Token> m_previous, m_current;
     std::vector<Context> m_contextStack;
 
-    std::stack<std::vector<JumpIndexes>> m_breakJumpIndexesStack, m_continueJumpIndexesStack;
+    std::stack<std::vector<JumpOffset>> m_breakJumpOffsetsStack, m_continueJumpOffsetsStack;
 
     std::vector<LocalVariable> m_localNames;
+    // the variables captured by the lambda currently being compiled
+    std::vector<LocalVariable> m_upvalueNames;
 
     std::optional<runtime::Value> m_mainFunction{};
 };  // class Compiler
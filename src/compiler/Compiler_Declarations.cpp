@@ -131,12 +131,10 @@ auto Compiler::funcDeclaration(bool isExported) -> void
     } else if (match(scanner::TokenType::Arrow)) {
         if (scanner::isValidStartOfExpression(m_current->tokenType())) {
             expression(false, false);
-            emitConstant(0);
             if (lastOpWasAssignment()) {
-                emitConstant(runtime::Value::none());
-                emitOp(runtime::Op::LoadConstant, m_previous->line());
+                emitConstant(runtime::Value::none(), m_previous->line());
             }
-            emitOp(runtime::Op::PopLocals, m_previous->line());
+            convertTailCall();
             emitOp(runtime::Op::Return, m_previous->line());
             EXPECT_SEMICOLON();
         } else {
@@ -148,11 +146,8 @@ auto Compiler::funcDeclaration(bool isExported) -> void
     }
 
     if (!checkLastOp(runtime::Op::Return)) {
-        // if no return statement, make sure we pop locals and implicitly return none
-        emitConstant(0);
-        emitOp(runtime::Op::PopLocals, m_previous->line());
-        emitConstant(runtime::Value::none());
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        // if no return statement, implicitly return none, Return pops the locals
+        emitConstant(runtime::Value::none(), m_previous->line());
         emitOp(runtime::Op::Return, m_previous->line());
     }
 
@@ -232,7 +227,7 @@ auto Compiler::varDeclaration(bool isFinal) -> void
         numDeclarations++;
     }
 
-    const auto function = m_vm->currentFunction();
+    const auto chunk = m_vm->currentChunk();
 
     // need to allow `try ...<collection>` with 0 or more other expressions
     if (match(scanner::TokenType::Equal)) {
@@ -256,9 +251,8 @@ auto Compiler::varDeclaration(bool isFinal) -> void
 
             numExpressions++;
 
-            const auto ops = function->opList();
-            if (ops.back().op == runtime::Op::Unpack
-                || (ops.size() > 1_uz && ops.back().op == runtime::Op::ExitTry && ops[ops.size() - 2_uz].op == runtime::Op::Unpack)) {
+            if (chunk->lastOp() == runtime::Op::Unpack
+                || (chunk->lastOp() == runtime::Op::ExitTry && chunk->opFromBack(1_uz) == runtime::Op::Unpack)) {
                 hadUnpack = true;
             }
         } while (match(scanner::TokenType::Comma));
@@ -279,10 +273,10 @@ auto Compiler::varDeclaration(bool isFinal) -> void
             }
         }
 
-        emitConstant(hadUnpack);
-        emitConstant(numDeclarations);
-        emitConstant(numExpressions);
         emitOp(runtime::Op::DeclareLocalsWithUnpack, m_previous->line());
+        emitOperand(hadUnpack);
+        emitOperand(static_cast<u32>(numDeclarations));
+        emitOperand(static_cast<u32>(numExpressions));
     } else {
         if (isFinal) {
             errorAtCurrent("Expected assignment after 'final'");
@@ -290,9 +284,7 @@ auto Compiler::varDeclaration(bool isFinal) -> void
         }
 
         for (auto i = 0_uz; i < numDeclarations; i++) {
-            emitConstant(runtime::Value::none());
-            emitOp(runtime::Op::LoadConstant, m_previous->line());
-            emitOp(runtime::Op::DeclareLocal, m_previous->line());
+            emitConstant(runtime::Value::none(), m_previous->line());
         }
 
         EXPECT_SEMICOLON();
@@ -6,21 +6,18 @@
 #include "Compiler_Macros.hpp"
 #include "../runtime/memory/StringInterner.hpp"
 
+#include <algorithm>
 #include <charconv>
 #include <version>
 
 namespace poise::compiler {
 auto Compiler::expression(bool canAssign, bool canUnpack) -> void
 {
-    const auto function = m_vm->currentFunction();
-    std::optional<usize> jumpConstantIndex, jumpOpIndex;
+    std::optional<JumpOffset> catchJumpOffset;
 
     if (match(scanner::TokenType::Try)) {
-        jumpConstantIndex = function->numConstants();
-        emitConstant(0_uz);
-        jumpOpIndex = function->numConstants();
-        emitConstant(0_uz);
         emitOp(runtime::Op::EnterTry, m_previous->line());
+        catchJumpOffset = emitJumpOperand();
     }
 
     // expressions can only start with a literal, unary op, or identifier
@@ -36,12 +33,9 @@ auto Compiler::expression(bool canAssign, bool canUnpack) -> void
         errorAtCurrent("Expected expression");
     }
 
-    if (jumpConstantIndex) {
+    if (catchJumpOffset) {
         emitOp(runtime::Op::ExitTry, m_previous->line());
-        const auto numConstants = function->numConstants();
-        const auto numOps = function->numOps();
-        function->setConstant(numConstants, *jumpConstantIndex);
-        function->setConstant(numOps, *jumpOpIndex);
+        patchJump(*catchJumpOffset);
     }
 }
 
@@ -62,15 +56,14 @@ auto Compiler::range(bool canAssign) -> void
         if (match(scanner::TokenType::By)) {
             expression(false, false);
         } else {
-            emitConstant(1);
-            emitOp(runtime::Op::LoadConstant, m_previous->line());
+            emitConstant(1, m_previous->line());
         }
 
-        emitConstant(static_cast<u8>(runtime::types::Type::Range));
-        emitConstant(3);
-        emitConstant(false);
-        emitConstant(inclusive);
         emitOp(runtime::Op::ConstructBuiltin, m_previous->line());
+        emitOperand(static_cast<u8>(runtime::types::Type::Range));
+        emitOperand(3_u8);
+        emitOperand(false);
+        emitOperand(inclusive);
 
     }
 }
@@ -79,9 +72,9 @@ auto Compiler::logicOr(bool canAssign) -> void
 {
     logicAnd(canAssign);
 
-    std::optional<JumpIndexes> jumpIndexes;
+    std::optional<JumpOffset> jumpOffset;
     if (check(scanner::TokenType::Or)) {
-        jumpIndexes = emitJump(JumpType::IfTrue, false);
+        jumpOffset = emitJump(JumpType::IfTrue, false);
     }
 
     while (match(scanner::TokenType::Or)) {
@@ -89,8 +82,8 @@ auto Compiler::logicOr(bool canAssign) -> void
         emitOp(runtime::Op::LogicOr, m_previous->line());
     }
 
-    if (jumpIndexes) {
-        patchJump(*jumpIndexes);
+    if (jumpOffset) {
+        patchJump(*jumpOffset);
     }
 }
 
@@ -98,9 +91,9 @@ auto Compiler::logicAnd(bool canAssign) -> void
 {
     bitwiseOr(canAssign);
 
-    std::optional<JumpIndexes> jumpIndexes;
+    std::optional<JumpOffset> jumpOffset;
     if (check(scanner::TokenType::And)) {
-        jumpIndexes = emitJump(JumpType::IfFalse, false);
+        jumpOffset = emitJump(JumpType::IfFalse, false);
     }
 
     while (match(scanner::TokenType::And)) {
@@ -108,8 +101,8 @@ auto Compiler::logicAnd(bool canAssign) -> void
         emitOp(runtime::Op::LogicAnd, m_previous->line());
     }
 
-    if (jumpIndexes) {
-        patchJump(*jumpIndexes);
+    if (jumpOffset) {
+        patchJump(*jumpOffset);
     }
 }
 
@@ -149,10 +142,10 @@ auto Compiler::equality(bool canAssign) -> void
 
     if (match(scanner::TokenType::EqualEqual)) {
         comparison(canAssign);
-        emitOp(runtime::Op::Equal, m_previous->line());
+        emitBinaryOp(runtime::Op::Equal, m_previous->line());
     } else if (match(scanner::TokenType::NotEqual)) {
         comparison(canAssign);
-        emitOp(runtime::Op::NotEqual, m_previous->line());
+        emitBinaryOp(runtime::Op::NotEqual, m_previous->line());
     }
 }
 
@@ -162,16 +155,16 @@ auto Compiler::comparison(bool canAssign) -> void
 
     if (match(scanner::TokenType::Less)) {
         shift(canAssign);
-        emitOp(runtime::Op::LessThan, m_previous->line());
+        emitBinaryOp(runtime::Op::LessThan, m_previous->line());
     } else if (match(scanner::TokenType::LessEqual)) {
         shift(canAssign);
-        emitOp(runtime::Op::LessEqual, m_previous->line());
+        emitBinaryOp(runtime::Op::LessEqual, m_previous->line());
     } else if (match(scanner::TokenType::Greater)) {
         shift(canAssign);
-        emitOp(runtime::Op::GreaterThan, m_previous->line());
+        emitBinaryOp(runtime::Op::GreaterThan, m_previous->line());
     } else if (match(scanner::TokenType::GreaterEqual)) {
         shift(canAssign);
-        emitOp(runtime::Op::GreaterEqual, m_previous->line());
+        emitBinaryOp(runtime::Op::GreaterEqual, m_previous->line());
     }
 }
 
@@ -199,10 +192,10 @@ auto Compiler::term(bool canAssign) -> void
     while (true) {
         if (match(scanner::TokenType::Plus)) {
             factor(canAssign);
-            emitOp(runtime::Op::Addition, m_previous->line());
+            emitBinaryOp(runtime::Op::Addition, m_previous->line());
         } else if (match(scanner::TokenType::Minus)) {
             factor(canAssign);
-            emitOp(runtime::Op::Subtraction, m_previous->line());
+            emitBinaryOp(runtime::Op::Subtraction, m_previous->line());
         } else {
             break;
         }
@@ -216,13 +209,13 @@ auto Compiler::factor(bool canAssign) -> void
     while (true) {
         if (match(scanner::TokenType::Star)) {
             unary(canAssign);
-            emitOp(runtime::Op::Multiply, m_previous->line());
+            emitBinaryOp(runtime::Op::Multiply, m_previous->line());
         } else if (match(scanner::TokenType::Slash)) {
             unary(canAssign);
-            emitOp(runtime::Op::Divide, m_previous->line());
+            emitBinaryOp(runtime::Op::Divide, m_previous->line());
         } else if (match(scanner::TokenType::Modulus)) {
             unary(canAssign);
-            emitOp(runtime::Op::Modulus, m_previous->line());
+            emitBinaryOp(runtime::Op::Modulus, m_previous->line());
         } else {
             break;
         }
@@ -260,27 +253,33 @@ auto Compiler::call(bool canAssign) -> void
         if (match(scanner::TokenType::OpenParen)) {
             if (const auto args = parseCallArgs(scanner::TokenType::CloseParen)) {
                 const auto [numArgs, hasUnpack] = *args;
-                emitConstant(numArgs);
-                emitConstant(hasUnpack);
-                emitConstant(false);
                 emitOp(runtime::Op::Call, m_previous->line());
+                emitOperand(numArgs);
+                emitOperand(hasUnpack);
+                emitOperand(false);
             }
         } else if (match(scanner::TokenType::Dot)) {
             RETURN_IF_NO_MATCH(scanner::TokenType::Identifier, "Expected identifier");
-            emitConstant(runtime::memory::internString(m_previous->string()));
-            emitOp(runtime::Op::LoadMember, m_previous->line());
+            const auto memberNameHash = runtime::memory::internString(m_previous->string());
+            const auto memberLine = m_previous->line();
 
             if (match(scanner::TokenType::OpenParen)) {
-                emitConstant(true); // flag to dictate whether to push the parent back on the stack since this is a dot call
+                emitOp(runtime::Op::LoadMember, memberLine);
+                emitOperand(memberNameHash);
+                emitOperand(true); // flag to dictate whether to push the parent back on the stack since this is a dot call
+                emitOperand(m_vm->currentChunk()->addMemberCache());
                 if (const auto args = parseCallArgs(scanner::TokenType::CloseParen)) {
                     const auto [numArgs, hasUnpack] = *args;
-                    emitConstant(numArgs);
-                    emitConstant(hasUnpack);
-                    emitConstant(true);
                     emitOp(runtime::Op::Call, m_previous->line());
+                    emitOperand(numArgs);
+                    emitOperand(hasUnpack);
+                    emitOperand(true);
                 }
             } else {
-                emitConstant(false); // don't push parent back on to the stack
+                emitOp(runtime::Op::LoadMember, memberLine);
+                emitOperand(memberNameHash);
+                emitOperand(false); // don't push parent back on to the stack
+                emitOperand(m_vm->currentChunk()->addMemberCache());
             }
         } else if (match(scanner::TokenType::OpenSquareBracket)) {
             expression(false, false);
@@ -306,28 +305,22 @@ auto Compiler::call(bool canAssign) -> void
 auto Compiler::primary(bool canAssign) -> void
 {
     if (match(scanner::TokenType::False)) {
-        emitConstant(false);
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        emitConstant(false, m_previous->line());
     } else if (match(scanner::TokenType::True)) {
-        emitConstant(true);
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        emitConstant(true, m_previous->line());
     } else if (match(scanner::TokenType::Float)) {
         if (const auto f = parseFloat()) {
-            emitConstant(*f);
-            emitOp(runtime::Op::LoadConstant, m_previous->line());
+            emitConstant(*f, m_previous->line());
         }
     } else if (match(scanner::TokenType::Int)) {
         if (const auto i = parseInt()) {
-            emitConstant(*i);
-            emitOp(runtime::Op::LoadConstant, m_previous->line());
+            emitConstant(*i, m_previous->line());
         }
     } else if (match(scanner::TokenType::None)) {
-        emitConstant(runtime::Value::none());
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        emitConstant(runtime::Value::none(), m_previous->line());
     } else if (match(scanner::TokenType::String)) {
         if (auto s = parseString()) {
-            emitConstant(std::move(*s));
-            emitOp(runtime::Op::LoadConstant, m_previous->line());
+            emitConstant(runtime::Value::internedString(*s), m_previous->line());
         }
     } else if (match(scanner::TokenType::OpenParen)) {
         tupleOrGrouping();
@@ -373,16 +366,37 @@ auto Compiler::identifier(bool canAssign) -> void
             }
 
             expression(false, false);
-            emitConstant(*localIndex);
-            emitOp(runtime::Op::AssignLocal, m_previous->line());
+            if (!retargetRegisterOp(static_cast<u32>(*localIndex))) {
+                emitOp(runtime::Op::AssignLocal, m_previous->line());
+                emitOperand(static_cast<u32>(*localIndex));
+            }
         } else {
             // just loading the value
-            emitConstant(*localIndex);
             emitOp(runtime::Op::LoadLocal, m_previous->line());
+            emitOperand(static_cast<u32>(*localIndex));
+        }
+    } else if (const auto upvalueIndex = indexOfUpvalue(identifier)) {
+        // a variable captured by the lambda being compiled
+        if (match(scanner::TokenType::Equal)) {
+            if (!canAssign) {
+                errorAtPrevious("Assignment not allowed here");
+                return;
+            }
+
+            if (m_upvalueNames[*upvalueIndex].isFinal) {
+                errorAtPrevious(fmt::format("'{}' is marked final", m_upvalueNames[*upvalueIndex].name));
+                return;
+            }
+
+            expression(false, false);
+            emitOp(runtime::Op::AssignUpvalue, m_previous->line());
+            emitOperand(static_cast<u32>(*upvalueIndex));
+        } else {
+            emitOp(runtime::Op::LoadUpvalue, m_previous->line());
+            emitOperand(static_cast<u32>(*upvalueIndex));
         }
     } else if (const auto constant = m_vm->namespaceManager()->getConstant(m_filePathHash, identifier)) {
-        emitConstant(constant->value);
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        emitConstant(constant->value, m_previous->line());
     } else {
         if (identifier.starts_with("__")) {
             // trying to call a native function
@@ -390,13 +404,13 @@ auto Compiler::identifier(bool canAssign) -> void
         } else if (check(scanner::TokenType::ColonColon)) {
             // qualifying a function with a namespace
             namespaceQualifiedCall();
+        } else if (match(scanner::TokenType::OpenParen)) {
+            // calling a function in the same namespace, resolved by the link pass
+            directCall(m_filePathHash, runtime::memory::internString(std::move(identifier)));
         } else {
             // not a local, native call or a namespace qualification
-            // so trying to call/load a function in the same namespace
-            // resolve this at runtime
-            emitConstant(m_filePathHash);
-            emitConstant(runtime::memory::internString(std::move(identifier)));
-            emitOp(runtime::Op::LoadFunctionOrStruct, m_previous->line());
+            // so trying to load a function or struct in the same namespace
+            loadFunctionOrStruct(m_filePathHash, runtime::memory::internString(std::move(identifier)));
         }
     }
 }
@@ -405,7 +419,7 @@ auto Compiler::nativeCall() -> void
 {
     auto identifier = m_previous->text();
 
-    if (const auto hash = m_vm->nativeFunctionHash(identifier)) {
+    if (const auto index = m_vm->nativeFunctionIndex(identifier)) {
         if (!m_stdFile) {
             errorAtPrevious("Calling native functions is only allowed in standard library files");
             return;
@@ -418,7 +432,7 @@ auto Compiler::nativeCall() -> void
         }
 
         if (const auto args = parseCallArgs(scanner::TokenType::CloseParen)) {
-            const auto arity = m_vm->nativeFunctionArity(*hash);
+            const auto arity = m_vm->nativeFunctionArity(*index);
             const auto [numArgs, hasUnpack] = *args;
 
             if (hasUnpack) {
@@ -431,8 +445,8 @@ auto Compiler::nativeCall() -> void
                 return;
             }
 
-            emitConstant(*hash);
             emitOp(runtime::Op::CallNative, m_previous->line());
+            emitOperand(*index);
         }
     } else {
         errorAtPrevious(fmt::format("Unrecognised native function '{}'", identifier));
@@ -460,25 +474,67 @@ auto Compiler::namespaceQualifiedCall() -> void
             return;
         }
 
-        emitConstant(constant->value);
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        emitConstant(constant->value, m_previous->line());
     } else {
-        emitConstant(namespaceHash);
-        emitConstant(runtime::memory::internString(m_previous->string()));
-        emitOp(runtime::Op::LoadFunctionOrStruct, m_previous->line());
-
+        const auto functionNameHash = runtime::memory::internString(m_previous->string());
         if (match(scanner::TokenType::OpenParen)) {
-            if (const auto args = parseCallArgs(scanner::TokenType::CloseParen)) {
-                const auto [numArgs, hasUnpack] = *args;
-                emitConstant(numArgs);
-                emitConstant(hasUnpack);
-                emitConstant(false);
-                emitOp(runtime::Op::Call, m_previous->line());
-            }
+            directCall(namespaceHash, functionNameHash);
+        } else {
+            loadFunctionOrStruct(namespaceHash, functionNameHash);
         }
     }
 }
 
+auto Compiler::loadFunctionOrStruct(usize namespaceHash, usize nameHash) -> void
+{
+    const auto chunk = m_vm->currentChunk();
+    m_vm->addLinkSite({
+        .kind = runtime::Vm::LinkSite::Kind::Load,
+        .chunk = chunk,
+        .index = chunk->size(),
+        .namespaceHash = namespaceHash,
+        .nameHash = nameHash,
+        .callerNamespaceHash = m_filePathHash,
+        .callerFilePath = m_filePath,
+        .line = m_previous->line(),
+    });
+
+    // the function or struct is filled in by the link pass, it isn't owned by the chunk
+    // because a function that loads itself (or two that load each other) would never be freed
+    emitOp(runtime::Op::LoadDirect, m_previous->line());
+    emitOperand(0_uz);
+}
+
+auto Compiler::directCall(usize namespaceHash, usize functionNameHash) -> void
+{
+    const auto nameLine = m_previous->line();
+    if (const auto args = parseCallArgs(scanner::TokenType::CloseParen)) {
+        emitDirectCall(namespaceHash, functionNameHash, *args, nameLine, m_previous->line());
+    }
+}
+
+auto Compiler::emitDirectCall(usize namespaceHash, usize functionNameHash, CallArgsParseResult args, usize nameLine, usize line) const noexcept -> void
+{
+    const auto chunk = m_vm->currentChunk();
+    m_vm->addLinkSite({
+        .kind = runtime::Vm::LinkSite::Kind::Call,
+        .chunk = chunk,
+        .index = chunk->size(),
+        .namespaceHash = namespaceHash,
+        .nameHash = functionNameHash,
+        .callerNamespaceHash = m_filePathHash,
+        .callerFilePath = m_filePath,
+        .line = nameLine,
+    });
+
+    // the number of args is checked and the function is filled in by the link pass
+    emitOp(runtime::Op::CallDirect, line);
+    emitOperand(args.numArgs);
+    emitOperand(args.hasUnpack);
+    emitOperand(false);
+    emitOperand(0_uz);
+}
+
 auto Compiler::typeIdent() -> void
 {
     const auto tokenType = m_previous->tokenType();
@@ -542,18 +598,16 @@ auto Compiler::typeIdent() -> void
                     break;
             }
 
-            emitConstant(static_cast<u8>(tokenType));
-            emitConstant(numArgs);
-            emitConstant(hasUnpack);
-            if (tokenType == scanner::TokenType::RangeIdent) {
-                emitConstant(false);
-            }
             emitOp(runtime::Op::ConstructBuiltin, m_previous->line());
+            emitOperand(static_cast<u8>(tokenType));
+            emitOperand(numArgs);
+            emitOperand(hasUnpack);
+            emitOperand(false); // only used for ranges, constructing with `Range()` is never inclusive
         }
     } else {
         // just loading the type itself
-        emitConstant(static_cast<u8>(tokenType));
         emitOp(runtime::Op::LoadType, m_previous->line());
+        emitOperand(static_cast<u8>(tokenType));
     }
 }
 
@@ -567,7 +621,13 @@ auto Compiler::typeOf() -> void
 
 auto Compiler::lambda() -> void
 {
-    std::vector<usize> captureIndexes;
+    struct Capture
+    {
+        runtime::Op op;  // CaptureLocal or CaptureUpvalue
+        usize index;
+    };
+
+    std::vector<Capture> captureOps;
     std::vector<LocalVariable> captures;
 
     while (!match(scanner::TokenType::Pipe)) {
@@ -578,7 +638,10 @@ auto Compiler::lambda() -> void
             }
 
             const auto text = m_previous->text();
-            if (const auto localIndex = indexOfLocal(text)) {
+            // a local of the enclosing function, or a variable the enclosing lambda has itself captured
+            const auto localIndex = indexOfLocal(text);
+            const auto upvalueIndex = indexOfUpvalue(text);
+            if (localIndex || upvalueIndex) {
                 if (std::ranges::find_if(captures, [&text] (const LocalVariable& local) -> bool {
                     return local.name == text;
                 }) != captures.end()) {
@@ -586,8 +649,13 @@ auto Compiler::lambda() -> void
                     return;
                 }
 
-                captures.push_back(m_localNames[*localIndex]);
-                captureIndexes.push_back(*localIndex);
+                if (localIndex) {
+                    captures.push_back(m_localNames[*localIndex]);
+                    captureOps.push_back({runtime::Op::CaptureLocal, *localIndex});
+                } else {
+                    captures.push_back(m_upvalueNames[*upvalueIndex]);
+                    captureOps.push_back({runtime::Op::CaptureUpvalue, *upvalueIndex});
+                }
 
                 // trailing commas are allowed but all arguments must be comma separated
                 // so here, if the next token is not a comma or a pipe, it's invalid
@@ -607,8 +675,11 @@ auto Compiler::lambda() -> void
         }
     }
 
+    // the lambda's locals start with its params, its captures are read through its upvalues
     auto oldLocals = std::move(m_localNames);
-    m_localNames = std::move(captures);
+    auto oldUpvalues = std::move(m_upvalueNames);
+    m_localNames.clear();
+    m_upvalueNames = std::move(captures);
 
     std::optional<FunctionParamsParseResult> params;
     if (match(scanner::TokenType::OpenParen)) {
@@ -632,16 +703,12 @@ auto Compiler::lambda() -> void
     auto lambdaName = fmt::format("{}_lambda{}", prevFunction->name(), prevFunction->numLambdas());
 
     // untracked because this lives in the constant list
-    // during runtime, a shallow clone is made which IS tracked along with its captures
+    // during runtime, a closure sharing its code is made which IS tracked along with its captures
     auto lambda = runtime::Value::createObjectUntracked<objects::Function>(std::move(lambdaName), m_filePath, m_filePathHash, arity, false, hasVariadicParams);
     auto functionPtr = lambda.object()->asFunction();
+    functionPtr->setNumCaptures(static_cast<u8>(captureOps.size()));
     m_vm->setCurrentFunction(functionPtr);
 
-    for (auto i = 0_uz; i < m_localNames.size() - arity; i++) {
-        emitConstant(i);
-        emitOp(runtime::Op::LoadCapture, m_previous->line());
-    }
-
     if (match(scanner::TokenType::OpenBrace)) {
         if (!parseBlock("lambda")) {
             return;
@@ -652,12 +719,10 @@ auto Compiler::lambda() -> void
         // if it's a return statement, nothing to be done
         if (scanner::isValidStartOfExpression(m_current->tokenType())){
             expression(true, false);
-            emitConstant(0);
             if (lastOpWasAssignment()) {
-                emitConstant(runtime::Value::none());
-                emitOp(runtime::Op::LoadConstant, m_previous->line());
+                emitConstant(runtime::Value::none(), m_previous->line());
             }
-            emitOp(runtime::Op::PopLocals, m_previous->line());
+            convertTailCall();
             emitOp(runtime::Op::Return, m_previous->line());
         } else {
             statement(false);
@@ -669,11 +734,8 @@ auto Compiler::lambda() -> void
     }
 
     if (!checkLastOp(runtime::Op::Return)) {
-        // if no return statement, make sure we pop locals and implicitly return none
-        emitConstant(0);
-        emitOp(runtime::Op::PopLocals, m_previous->line());
-        emitConstant(runtime::Value::none());
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        // if no return statement, implicitly return none, Return pops the locals
+        emitConstant(runtime::Value::none(), m_previous->line());
         emitOp(runtime::Op::Return, m_previous->line());
     }
 
@@ -682,16 +744,17 @@ auto Compiler::lambda() -> void
 #endif
 
     m_localNames = std::move(oldLocals);
+    m_upvalueNames = std::move(oldUpvalues);
     m_contextStack.pop_back();
 
     m_vm->setCurrentFunction(prevFunction);
     prevFunction->lamdaAdded();
 
-    emitConstant(std::move(lambda));
     emitOp(runtime::Op::MakeLambda, m_previous->line());
-    for (const auto index : captureIndexes) {
-        emitConstant(index);
-        emitOp(runtime::Op::CaptureLocal, m_previous->line());
+    emitOperand(makeConstant(std::move(lambda)));
+    for (const auto [op, index] : captureOps) {
+        emitOp(op, m_previous->line());
+        emitOperand(static_cast<u32>(index));
     }
 }
 
@@ -703,20 +766,22 @@ auto Compiler::list() -> void
     }
 
     const auto [numArgs, hasUnpack] = *args;
-    emitConstant(static_cast<u8>(runtime::types::Type::List));
-    emitConstant(numArgs);
-    emitConstant(hasUnpack);
     emitOp(runtime::Op::ConstructBuiltin, m_previous->line());
+    emitOperand(static_cast<u8>(runtime::types::Type::List));
+    emitOperand(numArgs);
+    emitOperand(hasUnpack);
+    emitOperand(false);
 }
 
 auto Compiler::tupleOrGrouping() -> void
 {
     if (match(scanner::TokenType::DotDotDot)) {
         unpack();
-        emitConstant(static_cast<u8>(runtime::types::Type::Tuple));
-        emitConstant(1);
-        emitConstant(true);
         emitOp(runtime::Op::ConstructBuiltin, m_previous->line());
+        emitOperand(static_cast<u8>(runtime::types::Type::Tuple));
+        emitOperand(1_u8);
+        emitOperand(true);
+        emitOperand(false);
         RETURN_IF_NO_MATCH(scanner::TokenType::CloseParen, "Expected ')'");
     } else {
         expression(false, false);
@@ -724,10 +789,11 @@ auto Compiler::tupleOrGrouping() -> void
         if (match(scanner::TokenType::Comma)) {
             if (const auto args = parseCallArgs(scanner::TokenType::CloseParen)) {
                 const auto [numArgs, hasUnpack] = *args;
-                emitConstant(static_cast<u8>(runtime::types::Type::Tuple));
-                emitConstant(numArgs + 1);
-                emitConstant(hasUnpack);
                 emitOp(runtime::Op::ConstructBuiltin, m_previous->line());
+                emitOperand(static_cast<u8>(runtime::types::Type::Tuple));
+                emitOperand(static_cast<u8>(numArgs + 1_u8));
+                emitOperand(hasUnpack);
+                emitOperand(false);
             }
         } else {
             RETURN_IF_NO_MATCH(scanner::TokenType::CloseParen, "Expected ')'");
@@ -744,10 +810,11 @@ auto Compiler::dict() -> void
     }
 
     const auto [numArgs, hasUnpack] = *args;
-    emitConstant(static_cast<u8>(runtime::types::Type::Dict));
-    emitConstant(numArgs);
-    emitConstant(hasUnpack);
     emitOp(runtime::Op::ConstructBuiltin, m_previous->line());
+    emitOperand(static_cast<u8>(runtime::types::Type::Dict));
+    emitOperand(numArgs);
+    emitOperand(hasUnpack);
+    emitOperand(false);
 }
 
 static auto getEscapeCharacter(char c) -> std::optional<char>
@@ -768,6 +835,86 @@ static auto getEscapeCharacter(char c) -> std::optional<char>
     }
 }
 
+auto Compiler::emitBinaryOp(runtime::Op op, usize line) -> void
+{
+    if (m_vm->registerOps()) {
+        if (const auto registerOp = runtime::threeAddressOp(op)) {
+            if (const auto operands = takeRegisterOperands()) {
+                const auto [lhs, rhs] = *operands;
+                emitOp(*registerOp, line);
+                emitOperand(lhs);
+                emitOperand(rhs);
+                emitOperand(runtime::RegisterStack);
+                return;
+            }
+        }
+    }
+
+    emitOp(op, line);
+}
+
+auto Compiler::takeRegisterOperand() -> std::optional<u32>
+{
+    // an operand that was just loaded from a local or a constant can be read directly by the three-address op
+    const auto chunk = m_vm->currentChunk();
+    const auto lastOp = chunk->lastOp();
+    if (lastOp != runtime::Op::LoadLocal && lastOp != runtime::Op::LoadConstant) {
+        return {};
+    }
+
+    const auto index = chunk->operandAt<u32>(*chunk->lastOpOffset() + 1_uz);
+    POISE_ASSERT((index & runtime::RegisterConstantBit) == 0_u32, "Too many locals or constants for a register operand");
+
+    if (!chunk->removeLastOp()) {
+        return {};
+    }
+
+    return lastOp == runtime::Op::LoadConstant ? index | runtime::RegisterConstantBit : index;
+}
+
+auto Compiler::takeRegisterOperands() -> std::optional<std::tuple<u32, u32>>
+{
+    const auto chunk = m_vm->currentChunk();
+    const auto lastOp = chunk->lastOp();
+
+    if (lastOp == runtime::Op::LoadLocalLoadLocal || lastOp == runtime::Op::LoadLocalLoadConstant) {
+        // both operands were loaded by a superinstruction
+        const auto offset = *chunk->lastOpOffset();
+        const auto lhs = chunk->operandAt<u32>(offset + 1_uz);
+        const auto rhs = chunk->operandAt<u32>(offset + 1_uz + sizeof(u32));
+
+        if (!chunk->removeLastOp()) {
+            return {};
+        }
+
+        return std::tuple{lhs, lastOp == runtime::Op::LoadLocalLoadConstant ? rhs | runtime::RegisterConstantBit : rhs};
+    }
+
+    if (const auto rhs = takeRegisterOperand()) {
+        // the left hand side stays on the stack if it was anything more complicated
+        return std::tuple{takeRegisterOperand().value_or(runtime::RegisterStack), *rhs};
+    }
+
+    return {};
+}
+
+auto Compiler::retargetRegisterOp(u32 localIndex) -> bool
+{
+    // `x = a + b` can write the result straight to the local instead of pushing it to the stack for an AssignLocal
+    const auto chunk = m_vm->currentChunk();
+    if (!m_vm->registerOps() || !chunk->lastOp() || !runtime::isThreeAddressOp(*chunk->lastOp()) || chunk->endIsJumpTarget()) {
+        return false;
+    }
+
+    const auto destinationOffset = chunk->size() - sizeof(u32);
+    if (chunk->operandAt<u32>(destinationOffset) != runtime::RegisterStack) {
+        return false;
+    }
+
+    chunk->patchOperand(destinationOffset, localIndex);
+    return true;
+}
+
 auto Compiler::parseString() -> std::optional<std::string>
 {
     std::string result;
@@ -7,27 +7,33 @@
 #include "../runtime/Types.hpp"
 
 #include <limits>
+#include <ranges>
 
 namespace poise::compiler {
 auto Compiler::emitOp(runtime::Op op, usize line) const noexcept -> void
 {
-    m_vm->emitOp(op, line);
+    m_vm->currentChunk()->emitOp(op, line);
 }
 
-auto Compiler::emitConstant(runtime::Value value) const noexcept -> void
+auto Compiler::makeConstant(runtime::Value value) const noexcept -> u32
 {
-    m_vm->emitConstant(std::move(value));
+    return m_vm->currentChunk()->addConstant(std::move(value));
 }
 
-auto Compiler::emitJump() const noexcept -> JumpIndexes
+auto Compiler::emitConstant(runtime::Value value, usize line) const noexcept -> void
 {
-    return emitJump(JumpType::Jump, false);
+    const auto index = makeConstant(std::move(value));
+    emitOp(runtime::Op::LoadConstant, line);
+    emitOperand(index);
 }
 
-auto Compiler::emitJump(JumpType jumpType, bool emitPop) const noexcept -> JumpIndexes
+auto Compiler::emitJump() const noexcept -> JumpOffset
 {
-    const auto function = m_vm->currentFunction();
+    return emitJump(JumpType::Jump, false);
+}
 
+auto Compiler::emitJump(JumpType jumpType, bool emitPop) const noexcept -> JumpOffset
+{
     switch (jumpType) {
         case JumpType::IfFalse:
             emitOp(runtime::Op::JumpIfFalse, m_previous->line());
@@ -40,26 +46,42 @@ auto Compiler::emitJump(JumpType jumpType, bool emitPop) const noexcept -> JumpI
             break;
     }
 
-    const auto jumpConstantIndex = function->numConstants();
-    emitConstant(0_uz);
-    const auto jumpOpIndex = function->numConstants();
-    emitConstant(0_uz);
+    const auto jumpOffset = emitJumpOperand();
 
     if (jumpType != JumpType::Jump) {
-        emitConstant(emitPop);
+        emitOperand(emitPop);
     }
 
-    return {jumpConstantIndex, jumpOpIndex};
+    return jumpOffset;
+}
+
+auto Compiler::emitJumpOperand() const noexcept -> JumpOffset
+{
+    // placeholder target, to be filled in by patchJump
+    const auto jumpOffset = currentOffset();
+    emitOperand(0_u32);
+    return jumpOffset;
+}
+
+auto Compiler::emitJumpTo(usize target) const noexcept -> void
+{
+    emitOp(runtime::Op::Jump, m_previous->line());
+    emitOperand(static_cast<u32>(target));
 }
 
-auto Compiler::patchJump(JumpIndexes jumpIndexes) const noexcept -> void
+auto Compiler::patchJump(JumpOffset jumpOffset) const noexcept -> void
 {
-    const auto function = m_vm->currentFunction();
+    m_vm->currentChunk()->patchOperand(jumpOffset, static_cast<u32>(markJumpTarget()));
+}
 
-    const auto numOps = function->numOps();
-    const auto numConstants = function->numConstants();
-    function->setConstant(numOps, jumpIndexes.opIndex);
-    function->setConstant(numConstants, jumpIndexes.constantIndex);
+auto Compiler::currentOffset() const noexcept -> usize
+{
+    return m_vm->currentChunk()->size();
+}
+
+auto Compiler::markJumpTarget() const noexcept -> usize
+{
+    return m_vm->currentChunk()->markJumpTarget();
 }
 
 auto Compiler::advance() -> void
@@ -93,9 +115,10 @@ auto Compiler::check(scanner::TokenType expected) const noexcept -> bool
 
 auto Compiler::hasLocal(std::string_view localName) const noexcept -> bool
 {
+    // a lambda's captures can't be shadowed by its own locals either
     return std::ranges::find_if(m_localNames, [localName] (const LocalVariable& local) -> bool {
         return local.name == localName;
-    }) != m_localNames.end();
+    }) != m_localNames.end() || indexOfUpvalue(localName).has_value();
 }
 
 auto Compiler::findLocal(std::string_view localName) const noexcept -> std::optional<LocalVariable>
@@ -120,15 +143,58 @@ auto Compiler::indexOfLocal(std::string_view localName) const noexcept -> std::o
     return std::nullopt;
 }
 
+auto Compiler::indexOfUpvalue(std::string_view upvalueName) const noexcept -> std::optional<usize>
+{
+    if (const auto it = std::ranges::find_if(m_upvalueNames, [upvalueName] (const LocalVariable& upvalue) -> bool {
+        return upvalue.name == upvalueName;
+    }); it != m_upvalueNames.end()) {
+        return static_cast<usize>(std::distance(m_upvalueNames.begin(), it));
+    }
+
+    return std::nullopt;
+}
+
 auto Compiler::checkLastOp(runtime::Op op) const noexcept -> bool
 {
-    return !m_vm->currentFunction()->opList().empty() && m_vm->currentFunction()->opList().back().op == op;
+    return m_vm->currentChunk()->lastOp() == op;
 }
 
 auto Compiler::lastOpWasAssignment() const noexcept -> bool
 {
     // TODO: add member assignmen
-    return checkLastOp(runtime::Op::AssignLocal) || checkLastOp(runtime::Op::AssignIndex);
+    if (checkLastOp(runtime::Op::AssignLocal) || checkLastOp(runtime::Op::AssignUpvalue) || checkLastOp(runtime::Op::AssignIndex)) {
+        return true;
+    }
+
+    // a three-address op that writes to a local rather than the stack
+    const auto chunk = m_vm->currentChunk();
+    return chunk->lastOp() && runtime::isThreeAddressOp(*chunk->lastOp())
+        && chunk->operandAt<u32>(chunk->size() - sizeof(u32)) != runtime::RegisterStack;
+}
+
+auto Compiler::convertTailCall() const noexcept -> void
+{
+    // a try block in the returning function has to stay around to catch anything the call raises
+    for (const auto context : m_contextStack | std::views::reverse) {
+        if (context == Context::Try) {
+            return;
+        }
+
+        if (context == Context::Function || context == Context::Lambda) {
+            break;
+        }
+    }
+
+    // the tail call never falls through, anything jumping to the end still reaches the Return after it
+    const auto chunk = m_vm->currentChunk();
+    if (const auto offset = chunk->lastOpOffset()) {
+        auto& op = chunk->code()[*offset];
+        if (op == static_cast<u8>(runtime::Op::Call)) {
+            op = static_cast<u8>(runtime::Op::TailCall);
+        } else if (op == static_cast<u8>(runtime::Op::CallDirect)) {
+            op = static_cast<u8>(runtime::Op::TailCallDirect);
+        }
+    }
 }
 
 auto Compiler::checkNameCollisions(std::string_view structConstFuncName) -> bool
@@ -257,9 +323,7 @@ auto Compiler::parseFunctionParams(bool isLambda) -> std::optional<FunctionParam
         }
 
         auto argName = m_previous->string();
-        if (std::ranges::find_if(m_localNames, [&argName] (const LocalVariable& local) -> bool {
-            return local.name == argName;
-        }) != m_localNames.end()) {
+        if (hasLocal(argName)) {
             errorAtPrevious("Function parameter with the same name already declared");
             return {};
         }
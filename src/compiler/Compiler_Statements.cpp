@@ -5,6 +5,7 @@
 #include "Compiler.hpp"
 #include "Compiler_Macros.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 namespace poise::compiler {
@@ -88,13 +89,13 @@ auto Compiler::assertStatement(bool consumeSemicolon) -> void
         if (!message) {
             return;
         }
-        emitConstant(std::move(*message));
+        emitOp(runtime::Op::Assert, m_previous->line());
+        emitOperand(makeConstant(std::move(*message)));
     } else {
-        emitConstant("Assertion failed");
+        emitOp(runtime::Op::Assert, m_previous->line());
+        emitOperand(makeConstant("Assertion failed"));
     }
 
-    emitOp(runtime::Op::Assert, m_previous->line());
-
     RETURN_IF_NO_MATCH(scanner::TokenType::CloseParen, "Expected ')' after 'assert'");
 
     if (consumeSemicolon) {
@@ -106,22 +107,22 @@ auto Compiler::printStatement(bool err, bool newLine, bool consumeSemicolon) ->
 {
     RETURN_IF_NO_MATCH(scanner::TokenType::OpenParen, "Expected '(' after 'println'");
 
+    auto numExpressions = 0_u32;
+
     if (check(scanner::TokenType::CloseParen)) {
-        emitConstant("\n");
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
-        emitConstant(1_uz);
+        emitConstant("\n", m_previous->line());
+        numExpressions = 1_u32;
     } else {
-        auto numExpressions = 0_uz;
         do {
             expression(false, false);
             numExpressions++;
         } while (match(scanner::TokenType::Comma));
-        emitConstant(numExpressions);
     }
 
-    emitConstant(err);
-    emitConstant(newLine);
     emitOp(runtime::Op::Print, m_previous->line());
+    emitOperand(numExpressions);
+    emitOperand(err);
+    emitOperand(newLine);
 
     RETURN_IF_NO_MATCH(scanner::TokenType::CloseParen, "Expected ')' after 'println'");
 
@@ -134,18 +135,14 @@ auto Compiler::returnStatement(bool consumeSemicolon) -> void
 {
     if (match(scanner::TokenType::Semicolon)) {
         // emit none value to return if no value is returned
-        emitConstant(runtime::Value::none());
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
+        emitConstant(runtime::Value::none(), m_previous->line());
     } else {
         // else the return value should be any expression
         expression(false, false);
+        convertTailCall();
     }
 
-    // pop local variables
-    emitConstant(0);
-    emitOp(runtime::Op::PopLocals, m_previous->line());
-
-    // expression above is still on the stack
+    // expression above is still on the stack, Return pops it along with the locals
     emitOp(runtime::Op::Return, m_previous->line());
 
     if (consumeSemicolon) {
@@ -179,13 +176,14 @@ auto Compiler::tryStatement() -> void
 
     const auto numLocalsStart = m_localNames.size();
 
-    const auto function = m_vm->currentFunction();
-    const auto jumpConstantIndex = function->numConstants();
-    emitConstant(0_uz);
-    const auto jumpOpIndex = function->numConstants();
-    emitConstant(0_uz);
+    // the held iterators of the loops around the try block in this function
+    const auto functionIt = std::ranges::find_if(m_contextStack.rbegin(), m_contextStack.rend(), [] (Context context) -> bool {
+        return context == Context::Function || context == Context::Lambda;
+    });
+    const auto numHeldIterators = std::ranges::count(m_contextStack.rbegin(), functionIt, Context::ForLoop);
 
-    emitOp(runtime::Op::EnterTry, m_previous->line());
+    // nothing is emitted for entering the try block, just make sure its first op doesn't get fused into the op before it
+    const auto tryStart = markJumpTarget();
 
     RETURN_IF_NO_MATCH(scanner::TokenType::OpenBrace, "Expected '{'");
 
@@ -193,23 +191,23 @@ auto Compiler::tryStatement() -> void
         return;
     }
 
-    // no exception thrown - PopLocals, ExitTry, Jump (to after the catch)
-    // exception thrown - PopLocals
-
-    // these instructions are in the case of no exception thrown - need to pop locals, exit the try, and jump to after the catch block
-    emitConstant(numLocalsStart);
-    emitOp(runtime::Op::PopLocals, m_previous->line());
-    emitOp(runtime::Op::ExitTry, m_previous->line());
-    const auto jumpIndexes = emitJump();
-
-    // this patching is in the case of an exception being thrown - need to pop locals, and then continue into the catch block
-    const auto numConstants = function->numConstants();
-    const auto numOps = function->numOps();
-    function->setConstant(numConstants, jumpConstantIndex);
-    function->setConstant(numOps, jumpOpIndex);
+    const auto tryEnd = currentOffset();
 
-    emitConstant(numLocalsStart);
+    // no exception thrown - PopLocals, Jump (to after the catch)
+    // exception thrown - nothing, the vm truncates the stack to where it was before the try block
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
+    const auto jumpOffset = emitJump();
+
+    // in the case of an exception being thrown the vm has already truncated the stack back to the locals
+    // from before the try block and pushed the exception, so continue into the catch block
+    m_vm->currentChunk()->addExceptionHandler({
+        .start = tryStart,
+        .end = tryEnd,
+        .target = markJumpTarget(),
+        .numLocals = static_cast<u32>(numLocalsStart),
+        .numHeldIterators = static_cast<u32>(numHeldIterators),
+    });
 
     m_localNames.resize(numLocalsStart);
 
@@ -217,7 +215,7 @@ auto Compiler::tryStatement() -> void
     m_contextStack.pop_back();
     catchStatement();
 
-    patchJump(jumpIndexes);
+    patchJump(jumpOffset);
 }
 
 auto Compiler::catchStatement() -> void
@@ -235,8 +233,8 @@ auto Compiler::catchStatement() -> void
             return;
         }
 
+        // the exception is already on the stack in the local's slot
         m_localNames.push_back({m_previous->string(), false});
-        emitOp(runtime::Op::DeclareLocal, m_previous->line());
     } else {
         emitOp(runtime::Op::Pop, m_previous->line());
     }
@@ -247,8 +245,8 @@ auto Compiler::catchStatement() -> void
         return;
     }
 
-    emitConstant(numLocalsStart);
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
     m_localNames.resize(numLocalsStart);
 
     m_contextStack.pop_back();
@@ -269,30 +267,30 @@ auto Compiler::ifStatement() -> void
     const auto numLocalsStart = m_localNames.size();
 
     // jump if the condition fails, otherwise continue on and pop the condition result
-    const auto falseJumpIndexes = emitJump(JumpType::IfFalse, true);
+    const auto falseJumpOffset = emitJump(JumpType::IfFalse, true);
 
     if (!parseBlock("if statement")) {
         return;
     }
 
-    emitConstant(numLocalsStart);
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
     m_localNames.resize(numLocalsStart);
 
     if (match(scanner::TokenType::Else)) {
         // if we are here, the condition passed, and we executed the `if` block
         // so get ready to jump past the `else` block(s)
-        const auto trueJumpIndexes = emitJump();
+        const auto trueJumpOffset = emitJump();
         // and patch up the jump if the condition failed
-        patchJump(falseJumpIndexes);
+        patchJump(falseJumpOffset);
 
         if (match(scanner::TokenType::OpenBrace)) {
             if (!parseBlock("else block")) {
                 return;
             }
 
-            emitConstant(numLocalsStart);
             emitOp(runtime::Op::PopLocals, m_previous->line());
+            emitOperand(static_cast<u32>(numLocalsStart));
             m_localNames.resize(numLocalsStart);
         } else if (match(scanner::TokenType::If)) {
             ifStatement();
@@ -302,10 +300,10 @@ auto Compiler::ifStatement() -> void
         }
 
         // patch up the jump for skipping the `else` block(s)
-        patchJump(trueJumpIndexes);
+        patchJump(trueJumpOffset);
     } else {
         // no `else` block so no additional jumping, just patch up the false jump
-        patchJump(falseJumpIndexes);
+        patchJump(falseJumpOffset);
     }
 
     m_contextStack.pop_back();
@@ -319,17 +317,15 @@ auto Compiler::whileStatement() -> void
     }
 
     m_contextStack.push_back(Context::WhileLoop);
-    m_breakJumpIndexesStack.emplace();
-    m_continueJumpIndexesStack.emplace();
+    m_breakJumpOffsetsStack.emplace();
+    m_continueJumpOffsetsStack.emplace();
 
-    const auto function = m_vm->currentFunction();
     // need to jump here at the end of each iteration
-    const auto constantIndex = function->numConstants();
-    const auto opIndex = function->numOps();
+    const auto loopStart = markJumpTarget();
 
     expression(false, false);
     // jump to after the loop when the condition is false
-    const auto jumpIndexes = emitJump(JumpType::IfFalse, true);
+    const auto exitJumpOffset = emitJump(JumpType::IfFalse, true);
 
     RETURN_IF_NO_MATCH(scanner::TokenType::OpenBrace, "Expected '{'");
 
@@ -340,35 +336,33 @@ auto Compiler::whileStatement() -> void
     }
 
     // patch continue statements
-    const auto continueJumpIndexes = std::move(m_continueJumpIndexesStack.top());
-    m_continueJumpIndexesStack.pop();
-    for (const auto jumpIdxes : continueJumpIndexes) {
-        patchJump(jumpIdxes);
+    const auto continueJumpOffsets = std::move(m_continueJumpOffsetsStack.top());
+    m_continueJumpOffsetsStack.pop();
+    for (const auto jumpOffset : continueJumpOffsets) {
+        patchJump(jumpOffset);
     }
 
     // pop locals at the end of each iteration
-    emitConstant(numLocalsStart);
     m_localNames.resize(numLocalsStart);
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
 
     // jump back to re-evaluate the condition
-    emitConstant(constantIndex);
-    emitConstant(opIndex);
-    emitOp(runtime::Op::Jump, m_previous->line());
+    emitJumpTo(loopStart);
 
     // patch break statements
-    const auto breakJumpIndexes = std::move(m_breakJumpIndexesStack.top());
-    m_breakJumpIndexesStack.pop();
-    for (const auto jumpIdxes : breakJumpIndexes) {
-        patchJump(jumpIdxes);
+    const auto breakJumpOffsets = std::move(m_breakJumpOffsetsStack.top());
+    m_breakJumpOffsetsStack.pop();
+    for (const auto jumpOffset : breakJumpOffsets) {
+        patchJump(jumpOffset);
     }
 
     // pop locals if we broke
-    emitConstant(numLocalsStart);
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
 
     // patch in the jump for failing the condition
-    patchJump(jumpIndexes);
+    patchJump(exitJumpOffset);
 
     m_contextStack.pop_back();
 }
@@ -381,8 +375,8 @@ auto Compiler::forStatement() -> void
     }
 
     m_contextStack.push_back(Context::ForLoop);
-    m_breakJumpIndexesStack.emplace();
-    m_continueJumpIndexesStack.emplace();
+    m_breakJumpOffsetsStack.emplace();
+    m_continueJumpOffsetsStack.emplace();
 
     RETURN_IF_NO_MATCH(scanner::TokenType::Identifier, "Expected identifier");
 
@@ -392,9 +386,7 @@ auto Compiler::forStatement() -> void
     }
 
     const auto firstIteratorLocalIndex = m_localNames.size();
-    emitConstant(runtime::Value::none());
-    emitOp(runtime::Op::LoadConstant, m_previous->line());
-    emitOp(runtime::Op::DeclareLocal, m_previous->line());
+    emitConstant(runtime::Value::none(), m_previous->line());
     m_localNames.push_back({m_previous->string(), false});
 
     std::optional<usize> secondIteratorLocalIndex;
@@ -405,9 +397,7 @@ auto Compiler::forStatement() -> void
             return;
         }
         secondIteratorLocalIndex = m_localNames.size();
-        emitConstant(runtime::Value::none());
-        emitOp(runtime::Op::LoadConstant, m_previous->line());
-        emitOp(runtime::Op::DeclareLocal, m_previous->line());
+        emitConstant(runtime::Value::none(), m_previous->line());
         m_localNames.push_back({m_previous->string(), false});
     }
 
@@ -416,18 +406,27 @@ auto Compiler::forStatement() -> void
 
     RETURN_IF_NO_MATCH(scanner::TokenType::In, "Expected 'in'");
 
-    expression(false, false);
-    emitConstant(firstIteratorLocalIndex);
-    emitConstant(secondIteratorLocalIndex ? *secondIteratorLocalIndex : 0_uz);
+    // a range literal is iterated with its counter on the stack instead of making a Range and an Iterator,
+    // otherwise the start of the range is just the start of the expression being iterated
+    if (!secondIteratorLocalIndex && !check(scanner::TokenType::Try) && scanner::isValidStartOfExpression(m_current->tokenType())) {
+        logicOr(false);
+        if (match(scanner::TokenType::DotDot) || match(scanner::TokenType::DotDotEqual)) {
+            forRangeLoop(firstIteratorLocalIndex, m_previous->tokenType() == scanner::TokenType::DotDotEqual);
+            return;
+        }
+    } else {
+        expression(false, false);
+    }
+
     emitOp(runtime::Op::InitIterator, m_previous->line());
+    emitOperand(static_cast<u32>(firstIteratorLocalIndex));
+    emitOperand(static_cast<u32>(secondIteratorLocalIndex ? *secondIteratorLocalIndex : 0_uz));
 
-    const auto function = m_vm->currentFunction();
     // need to jump here at the end of each iteration
-    const auto constantIndex = function->numConstants();
-    const auto opIndex = function->numOps();
+    const auto loopStart = markJumpTarget();
 
     // after InitIterator and IncrementIterator, the value of Iterator::isAtEnd() is put onto the stack
-    const auto jumpIndexes = emitJump(JumpType::IfTrue, true);
+    const auto exitJumpOffset = emitJump(JumpType::IfTrue, true);
 
     RETURN_IF_NO_MATCH(scanner::TokenType::OpenBrace, "Expected '{'");
 
@@ -436,49 +435,110 @@ auto Compiler::forStatement() -> void
     }
 
     // patch continues
-    const auto continueJumpIndexes = std::move(m_continueJumpIndexesStack.top());
-    m_continueJumpIndexesStack.pop();
-    for (const auto jumpIdxes : continueJumpIndexes) {
-        patchJump(jumpIdxes);
+    const auto continueJumpOffsets = std::move(m_continueJumpOffsetsStack.top());
+    m_continueJumpOffsetsStack.pop();
+    for (const auto jumpOffset : continueJumpOffsets) {
+        patchJump(jumpOffset);
     }
 
-    emitConstant(firstIteratorLocalIndex);
-    emitConstant(secondIteratorLocalIndex ? *secondIteratorLocalIndex : 0_uz);
-    emitOp(runtime::Op::IncrementIterator, m_previous->line());
-
-    // pop locals at the end of each iteration
-    emitConstant(numLocalsStart);
+    // pop locals at the end of each iteration, before IncrementIterator pushes whether the iterator is at the end
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
     m_localNames.resize(numLocalsStart);
 
+    emitOp(runtime::Op::IncrementIterator, m_previous->line());
+    emitOperand(static_cast<u32>(firstIteratorLocalIndex));
+    emitOperand(static_cast<u32>(secondIteratorLocalIndex ? *secondIteratorLocalIndex : 0_uz));
+
     // jump back to check the iterator
-    emitConstant(constantIndex);
-    emitConstant(opIndex);
-    emitOp(runtime::Op::Jump, m_previous->line());
+    emitJumpTo(loopStart);
 
     // patch breaks
-    const auto breakJumpIndexes = std::move(m_breakJumpIndexesStack.top());
-    m_breakJumpIndexesStack.pop();
-    for (const auto jumpIdxes : breakJumpIndexes) {
-        patchJump(jumpIdxes);
+    const auto breakJumpOffsets = std::move(m_breakJumpOffsetsStack.top());
+    m_breakJumpOffsetsStack.pop();
+    for (const auto jumpOffset : breakJumpOffsets) {
+        patchJump(jumpOffset);
     }
 
     emitOp(runtime::Op::PopIterator, m_previous->line());
 
-    patchJump(jumpIndexes);
+    patchJump(exitJumpOffset);
 
     // finally, pop the iterators that were made as locals
-    emitConstant(numLocalsStart - (secondIteratorLocalIndex ? 2 : 1));
     emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart - (secondIteratorLocalIndex ? 2_uz : 1_uz)));
     m_localNames.resize(m_localNames.size() - (secondIteratorLocalIndex ? 2_uz : 1_uz));
 
     m_contextStack.pop_back();
 }
 
+auto Compiler::forRangeLoop(usize iteratorLocalIndex, bool inclusive) -> void
+{
+    m_contextStack.back() = Context::ForRangeLoop;
+
+    logicOr(false);
+
+    if (match(scanner::TokenType::By)) {
+        expression(false, false);
+    } else {
+        emitConstant(1, m_previous->line());
+    }
+
+    // the start, end, and increment stay where they are as hidden locals after the iterator,
+    // ForRangeInit turns them into the counter, the number of steps left, and the increment
+    m_localNames.push_back({"$counter", false});
+    m_localNames.push_back({"$remaining", false});
+    m_localNames.push_back({"$increment", false});
+    const auto numLocalsStart = m_localNames.size();
+
+    emitOp(runtime::Op::ForRangeInit, m_previous->line());
+    emitOperand(static_cast<u32>(iteratorLocalIndex));
+    emitOperand(inclusive);
+    const auto exitJumpOffset = emitJumpOperand();
+
+    // ForRangeStep jumps back here while there are steps left
+    const auto loopStart = markJumpTarget();
+
+    RETURN_IF_NO_MATCH(scanner::TokenType::OpenBrace, "Expected '{'");
+
+    if (!parseBlock("for loop")) {
+        return;
+    }
+
+    const auto continueJumpOffsets = std::move(m_continueJumpOffsetsStack.top());
+    m_continueJumpOffsetsStack.pop();
+    for (const auto jumpOffset : continueJumpOffsets) {
+        patchJump(jumpOffset);
+    }
+
+    emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(numLocalsStart));
+    m_localNames.resize(numLocalsStart);
+
+    emitOp(runtime::Op::ForRangeStep, m_previous->line());
+    emitOperand(static_cast<u32>(iteratorLocalIndex));
+    emitOperand(static_cast<u32>(loopStart));
+
+    // breaking and finishing the loop both just pop the iterator and the hidden locals, there's no held iterator
+    const auto breakJumpOffsets = std::move(m_breakJumpOffsetsStack.top());
+    m_breakJumpOffsetsStack.pop();
+    for (const auto jumpOffset : breakJumpOffsets) {
+        patchJump(jumpOffset);
+    }
+
+    patchJump(exitJumpOffset);
+
+    emitOp(runtime::Op::PopLocals, m_previous->line());
+    emitOperand(static_cast<u32>(iteratorLocalIndex));
+    m_localNames.resize(iteratorLocalIndex);
+
+    m_contextStack.pop_back();
+}
+
 auto Compiler::breakStatement() -> void
 {
     const auto loopIt = std::ranges::find_if(m_contextStack, [] (Context context) -> bool {
-        return context == Context::ForLoop || context == Context::WhileLoop;
+        return context == Context::ForLoop || context == Context::ForRangeLoop || context == Context::WhileLoop;
     });
 
     if (loopIt == m_contextStack.end()) {
@@ -491,11 +551,7 @@ auto Compiler::breakStatement() -> void
         return;
     }
 
-    if (const auto tryIt = std::ranges::find(m_contextStack, Context::Try); tryIt != m_contextStack.end() && tryIt > loopIt) {
-        emitOp(runtime::Op::ExitTry, m_previous->line());
-    }
-
-    m_breakJumpIndexesStack.top().push_back(emitJump(JumpType::Jump, false));
+    m_breakJumpOffsetsStack.top().push_back(emitJump(JumpType::Jump, false));
 
     EXPECT_SEMICOLON();
 }
@@ -503,7 +559,7 @@ auto Compiler::breakStatement() -> void
 auto Compiler::continueStatement() -> void
 {
     const auto loopIt = std::ranges::find_if(m_contextStack, [] (Context context) -> bool {
-        return context == Context::ForLoop || context == Context::WhileLoop;
+        return context == Context::ForLoop || context == Context::ForRangeLoop || context == Context::WhileLoop;
     });
 
     if (loopIt == m_contextStack.end()) {
@@ -516,11 +572,7 @@ auto Compiler::continueStatement() -> void
         return;
     }
 
-    if (const auto tryIt = std::ranges::find(m_contextStack, Context::Try); tryIt != m_contextStack.end() && tryIt > loopIt) {
-        emitOp(runtime::Op::ExitTry, m_previous->line());
-    }
-
-    m_continueJumpIndexesStack.top().push_back(emitJump(JumpType::Jump, false));
+    m_continueJumpOffsetsStack.top().push_back(emitJump(JumpType::Jump, false));
 
     EXPECT_SEMICOLON();
 }
@@ -14,7 +14,19 @@ int main(int argc, const char* argv[])
         std::exit(1);
     }
 
-    const auto verbose = argc >= 3 && (std::strcmp(argv[std::size_t{2}], "--verbose") == 0 || std::strcmp(argv[std::size_t{2}], "-v") == 0);
+    auto verbose = false;
+    auto registerOps = false;
+
+    for (auto i = std::size_t{2}; i < static_cast<std::size_t>(argc); i++) {
+        if (std::strcmp(argv[i], "--verbose") == 0 || std::strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (std::strcmp(argv[i], "--register-ops") == 0 || std::strcmp(argv[i], "-r") == 0) {
+            registerOps = true;
+        } else {
+            fmt::print(stderr, "Unknown option '{}'\n", argv[i]);
+            std::exit(1);
+        }
+    }
 
     std::filesystem::path inFilePath{argv[std::size_t{1}]};
 
@@ -29,6 +41,7 @@ int main(int argc, const char* argv[])
     }
 
     poise::runtime::Vm vm{inFilePath.string()};
+    vm.setRegisterOps(registerOps);
     poise::compiler::Compiler compiler{true, false, &vm, std::move(inFilePath)};
 
     {
@@ -9,40 +9,36 @@ namespace poise::objects {
 static std::hash<std::string> s_hasher;
 
 Function::Function(std::string name, std::filesystem::path filePath, usize namespaceHash, u8 arity, bool isExported, bool hasPack)
-    : m_name{std::move(name)}
-    , m_filePath{std::move(filePath)}
-    , m_arity{arity}
-    , m_nameHash{s_hasher(m_name)}
-    , m_namespaceHash{namespaceHash}
-    , m_isExported{isExported}
-    , m_hasVariadicParams{hasPack}
+    : m_prototype{std::make_shared<Prototype>(Prototype{
+        .name = name,
+        .filePath = std::move(filePath),
+        .arity = arity,
+        .nameHash = s_hasher(name),
+        .namespaceHash = namespaceHash,
+        .isExported = isExported,
+        .hasVariadicParams = hasPack,
+        .numCaptures = 0,
+        .numLambdas = 0,
+        .chunk = {},
+    })}
 {
 
 }
 
-auto Function::asFunction() noexcept -> Function*
-{
-    return this;
-}
-
-auto Function::emitOp(runtime::Op op, usize line) noexcept -> void
-{
-    m_ops.push_back({op, line});
-}
-
-auto Function::emitConstant(runtime::Value value) noexcept -> void
+Function::Function(std::shared_ptr<Prototype> prototype)
+    : m_prototype{std::move(prototype)}
 {
-    m_constants.emplace_back(std::move(value));
+    m_upvalues.reserve(m_prototype->numCaptures);
 }
 
-auto Function::setConstant(runtime::Value value, usize index) noexcept -> void
+auto Function::asFunction() noexcept -> Function*
 {
-    m_constants[index] = std::move(value);
+    return this;
 }
 
 auto Function::toString() const noexcept -> std::string
 {
-    return fmt::format("<function instance '{}' at {}>", m_name, fmt::ptr(this));
+    return fmt::format("<function instance '{}' at {}>", m_prototype->name, fmt::ptr(this));
 }
 
 auto Function::type() const noexcept -> runtime::types::Type
@@ -50,136 +46,113 @@ auto Function::type() const noexcept -> runtime::types::Type
     return runtime::types::Type::Function;
 }
 
-auto Function::findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void
+auto Function::findObjectMembers(std::vector<Object*>& objects) const noexcept -> void
 {
-    for (const auto& capture : m_captures) {
-        if (const auto object = capture.object()) {
-            if (const auto [_, inserted] = objects.insert(object); inserted) {
-                object->findObjectMembers(objects);
-            }
+    // an open upvalue's value is on the stack, so only closed ones are members of the function
+    for (const auto& upvalue : m_upvalues) {
+        if (upvalue->isOpen) {
+            continue;
+        }
+
+        if (const auto object = upvalue->value.object()) {
+            objects.push_back(object);
         }
     }
 }
 
 auto Function::removeObjectMembers() noexcept -> void
 {
-    for (auto& capture : m_captures) {
-        if (capture.object() != nullptr) {
-            capture = runtime::Value::none();
-        }
-    }
+    // other closures can share these upvalues, so only this function's references to them are dropped
+    m_upvalues.clear();
 }
 
 auto Function::anyMemberMatchesRecursive(const Object* object) const noexcept -> bool
 {
-    return std::ranges::any_of(m_captures, [object, this] (const auto& capture) -> bool {
-        const auto member = capture.object();
+    return std::ranges::any_of(m_upvalues, [object, this] (const auto& upvalue) -> bool {
+        const auto member = upvalue->isOpen ? nullptr : upvalue->value.object();
         return member != nullptr && (member == this || member == object || member->anyMemberMatchesRecursive(object));
     });
 }
 
-auto Function::opList() const noexcept -> std::span<const runtime::OpLine>
+auto Function::chunk() noexcept -> runtime::Chunk&
 {
-    return m_ops;
+    return m_prototype->chunk;
 }
 
-auto Function::numOps() const noexcept -> usize
+auto Function::chunk() const noexcept -> const runtime::Chunk&
 {
-    return m_ops.size();
-}
-
-auto Function::constantList() const noexcept -> std::span<const runtime::Value>
-{
-    return m_constants;
-}
-
-auto Function::numConstants() const noexcept -> usize
-{
-    return m_constants.size();
+    return m_prototype->chunk;
 }
 
 auto Function::name() const noexcept -> std::string_view
 {
-    return m_name;
+    return m_prototype->name;
 }
 
 auto Function::filePath() const noexcept -> const std::filesystem::path&
 {
-    return m_filePath;
+    return m_prototype->filePath;
 }
 
 auto Function::arity() const noexcept -> u8
 {
-    return m_arity;
+    return m_prototype->arity;
 }
 
 auto Function::nameHash() const noexcept -> usize
 {
-    return m_nameHash;
+    return m_prototype->nameHash;
 }
 
 auto Function::namespaceHash() const noexcept -> usize
 {
-    return m_namespaceHash;
+    return m_prototype->namespaceHash;
 }
 
 auto Function::exported() const noexcept -> bool
 {
-    return m_isExported;
+    return m_prototype->isExported;
 }
 
 auto Function::hasVariadicParams() const noexcept -> bool
 {
-    return m_hasVariadicParams;
+    return m_prototype->hasVariadicParams;
 }
 
 auto Function::numLambdas() const noexcept -> u32
 {
-    return m_numLambdas;
+    return m_prototype->numLambdas;
 }
 
 auto Function::lamdaAdded() noexcept -> void
 {
-    m_numLambdas++;
+    m_prototype->numLambdas++;
 }
 
-auto Function::addCapture(runtime::Value value) noexcept -> void
+auto Function::setNumCaptures(u8 numCaptures) noexcept -> void
 {
-    m_captures.emplace_back(std::move(value));
+    m_prototype->numCaptures = numCaptures;
 }
 
-auto Function::getCapture(usize index) const noexcept -> const runtime::Value&
+auto Function::addUpvalue(std::shared_ptr<Upvalue> upvalue) noexcept -> void
 {
-    return m_captures[index];
+    m_upvalues.push_back(std::move(upvalue));
 }
 
-auto Function::printOps() const -> void
+auto Function::upvalue(usize index) const noexcept -> const std::shared_ptr<Upvalue>&
 {
-    fmt::print("{}\n", toString());
-
-    fmt::print("Ops:\n");
-    for (auto i = 0_uz; i < m_ops.size(); i++) {
-        fmt::print("\t{}: {} at line {}\n", i, m_ops[i].op, m_ops[i].line);
-    }
-
-    fmt::print("Constants:\n");
-    for (auto i = 0_uz; i < m_constants.size(); i++) {
-        fmt::print("\t{}: {}\n", i, m_constants[i]);
-    }
+    POISE_ASSERT(index < m_upvalues.size(), "Upvalue out of range, there has been an error in codegen");
+    return m_upvalues[index];
 }
 
-auto Function::shallowClone() const noexcept -> runtime::Value
+auto Function::printOps() const -> void
 {
-    auto value = runtime::Value::createObject<Function>(m_name, m_filePath, m_namespaceHash, m_arity, m_isExported, m_hasVariadicParams);
-    const auto function = value.object()->asFunction();
-    function->copyData(*this);
-    return value;
+    fmt::print("{}\n", toString());
+    m_prototype->chunk.print();
 }
 
-auto Function::copyData(const Function& other) -> void
+auto Function::makeClosure() const noexcept -> runtime::Value
 {
-    m_numLambdas = other.numLambdas();
-    m_ops = other.m_ops;
-    m_constants = other.m_constants;
+    return runtime::Value::createObject<Function>(m_prototype);
 }
 }   // namespace poise::objects
@@ -4,9 +4,10 @@
 #include "../Poise.hpp"
 
 #include "Object.hpp"
-#include "../runtime/Op.hpp"
+#include "../runtime/Chunk.hpp"
 #include "../runtime/Value.hpp"
 
+#include <memory>
 #include <span>
 #include <vector>
 
@@ -14,25 +15,46 @@ namespace poise::objects {
 class Function : public Object
 {
 public:
+    // everything about a function that is the same for every closure made from it,
+    // shared so that making a closure doesn't copy the code
+    struct Prototype
+    {
+        std::string name;
+        std::filesystem::path filePath;
+        u8 arity;
+        usize nameHash;
+        usize namespaceHash;
+        bool isExported;
+        bool hasVariadicParams;
+        u8 numCaptures;
+        u32 numLambdas;
+        runtime::Chunk chunk;
+    };
+
+    // a variable captured by a lambda, while the variable is still in scope this refers to its slot on the stack
+    // and once it goes out of scope the vm closes it so it holds the value itself, every lambda capturing
+    // the same variable shares the same upvalue so they all see assignments to it
+    struct Upvalue
+    {
+        usize slot;
+        bool isOpen{true};
+        runtime::Value value{};
+    };
+
     Function(std::string name, std::filesystem::path filePath, usize namespaceHash, u8 arity, bool isExported, bool hasPack);
+    explicit Function(std::shared_ptr<Prototype> prototype);
     ~Function() override = default;
 
     [[nodiscard]] auto toString() const noexcept -> std::string override;
     [[nodiscard]] auto type() const noexcept -> runtime::types::Type override;
-    auto findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void override;
+    auto findObjectMembers(std::vector<Object*>& objects) const noexcept -> void override;
     auto removeObjectMembers() noexcept -> void override;
     [[nodiscard]] auto anyMemberMatchesRecursive(const Object* object) const noexcept -> bool override;
 
     auto asFunction() noexcept -> Function* override;
 
-    auto emitOp(runtime::Op op, usize line) noexcept -> void;
-    auto emitConstant(runtime::Value value) noexcept -> void;
-    auto setConstant(runtime::Value value, usize index) noexcept -> void;
-
-    [[nodiscard]] auto opList() const noexcept -> std::span<const runtime::OpLine>;
-    [[nodiscard]] auto numOps() const noexcept -> usize;
-    [[nodiscard]] auto constantList() const noexcept -> std::span<const runtime::Value>;
-    [[nodiscard]] auto numConstants() const noexcept -> usize;
+    [[nodiscard]] auto chunk() noexcept -> runtime::Chunk&;
+    [[nodiscard]] auto chunk() const noexcept -> const runtime::Chunk&;
 
     [[nodiscard]] auto name() const noexcept -> std::string_view;
     [[nodiscard]] auto filePath() const noexcept -> const std::filesystem::path&;
@@ -44,28 +66,17 @@ public:
 
     auto lamdaAdded() noexcept -> void;
     [[nodiscard]] auto numLambdas() const noexcept -> u32;
-    auto addCapture(runtime::Value value) noexcept -> void;
-    [[nodiscard]] auto getCapture(usize index) const noexcept -> const runtime::Value&;
-    [[nodiscard]] auto shallowClone() const noexcept -> runtime::Value;
+    auto setNumCaptures(u8 numCaptures) noexcept -> void;
+    auto addUpvalue(std::shared_ptr<Upvalue> upvalue) noexcept -> void;
+    [[nodiscard]] auto upvalue(usize index) const noexcept -> const std::shared_ptr<Upvalue>&;
+    // a new function sharing this one's prototype, with no upvalues yet
+    [[nodiscard]] auto makeClosure() const noexcept -> runtime::Value;
 
     auto printOps() const -> void;
 
 private:
-    auto copyData(const Function& other) -> void;
-
-    std::string m_name;
-    std::filesystem::path m_filePath;
-    u8 m_arity;
-    usize m_nameHash;
-    usize m_namespaceHash;
-    bool m_isExported;
-    bool m_hasVariadicParams;
-
-    u32 m_numLambdas{0};
-
-    std::vector<runtime::OpLine> m_ops;
-    std::vector<runtime::Value> m_constants;
-    std::vector<runtime::Value> m_captures;
+    std::shared_ptr<Prototype> m_prototype;
+    std::vector<std::shared_ptr<Upvalue>> m_upvalues;
 };  // class PoiseFunction
 }   // namespace poise::objects
 
@@ -1,4 +1,6 @@
 #include "Object.hpp"
+#include "../runtime/Value.hpp"
+#include "../runtime/memory/Gc.hpp"
 
 namespace poise::objects {
 auto Object::incrementRefCount() noexcept -> usize
@@ -26,6 +28,48 @@ auto Object::setTracking(bool tracking) noexcept -> void
     m_tracking = tracking;
 }
 
+auto Object::young() const noexcept -> bool
+{
+    return m_young;
+}
+
+auto Object::setYoung(bool young) noexcept -> void
+{
+    m_young = young;
+}
+
+auto Object::remembered() const noexcept -> bool
+{
+    return m_remembered;
+}
+
+auto Object::setRemembered(bool remembered) noexcept -> void
+{
+    m_remembered = remembered;
+}
+
+auto Object::marked() const noexcept -> bool
+{
+    return m_marked;
+}
+
+auto Object::setMarked(bool marked) noexcept -> void
+{
+    m_marked = marked;
+}
+
+auto Object::recordWrite(const runtime::Value& value) noexcept -> void
+{
+    // young objects are always scanned by a minor collection, only old objects pointing at young ones need remembering
+    if (!m_tracking || m_young || m_remembered) {
+        return;
+    }
+
+    if (const auto object = value.object(); object != nullptr && object->young()) {
+        runtime::memory::Gc::instance().rememberObject(this);
+    }
+}
+
 auto Object::asIterable() noexcept -> iterables::Iterable*
 {
     return nullptr;
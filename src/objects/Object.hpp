@@ -5,7 +5,7 @@
 #include "../runtime/Types.hpp"
 
 #include <string>
-#include <unordered_set>
+#include <vector>
 
 namespace poise::runtime {
 class Value;
@@ -46,6 +46,16 @@ public:
     [[nodiscard]] auto refCount() const noexcept -> usize;
     [[nodiscard]] auto tracking() const noexcept -> bool;
     auto setTracking(bool track) noexcept -> void;
+    [[nodiscard]] auto young() const noexcept -> bool;
+    auto setYoung(bool young) noexcept -> void;
+    [[nodiscard]] auto remembered() const noexcept -> bool;
+    auto setRemembered(bool remembered) noexcept -> void;
+    [[nodiscard]] auto marked() const noexcept -> bool;
+    auto setMarked(bool marked) noexcept -> void;
+
+    // must be called whenever a value is stored in an object that already exists,
+    // so that minor collections can find young objects that are only referenced by old ones
+    auto recordWrite(const runtime::Value& value) noexcept -> void;
 
     [[nodiscard]] virtual auto asIterable() noexcept -> iterables::Iterable*;
     [[nodiscard]] virtual auto asHashable() noexcept -> iterables::hashables::Hashable*;
@@ -63,7 +73,8 @@ public:
 
     [[nodiscard]] virtual auto toString() const noexcept -> std::string = 0;
     [[nodiscard]] virtual auto type() const noexcept -> runtime::types::Type = 0;
-    virtual auto findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void = 0;
+    // only the direct members are added, the Gc decides which of them to visit
+    virtual auto findObjectMembers(std::vector<Object*>& objects) const noexcept -> void = 0;
     virtual auto removeObjectMembers() noexcept -> void = 0;
     [[nodiscard]] virtual auto anyMemberMatchesRecursive(const Object* object) const noexcept -> bool = 0;
 
@@ -72,6 +83,9 @@ public:
 private:
     usize m_refCount{};
     bool m_tracking{};
+    bool m_young{};
+    bool m_remembered{};
+    bool m_marked{};
 };  // class PoiseObjects
 }   // namespace poise::objects
 
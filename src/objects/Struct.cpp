@@ -27,13 +27,11 @@ auto Struct::type() const noexcept -> runtime::types::Type
     return runtime::types::Type::Struct;
 }
 
-auto Struct::findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void
+auto Struct::findObjectMembers(std::vector<Object*>& objects) const noexcept -> void
 {
     for (const auto& member : m_memberVariables) {
         if (auto object = member.value.object()) {
-            if (const auto [_, inserted] = objects.insert(object); inserted) {
-                object->findObjectMembers(objects);
-            }
+            objects.push_back(object);
         }
     }
 }
@@ -80,6 +78,7 @@ auto Struct::assignMember(usize memberNameHash, runtime::Value value) -> bool
 {
     for (auto& member : m_memberVariables) {
         if (member.nameHash == memberNameHash) {
+            recordWrite(value);
             member.value = std::move(value);
             return true;
         }
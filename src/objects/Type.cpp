@@ -24,7 +24,7 @@ auto Type::type() const noexcept -> runtime::types::Type
     return runtime::types::Type::Type;
 }
 
-auto Type::findObjectMembers([[maybe_unused]] std::unordered_set<Object*>& objects) const noexcept -> void
+auto Type::findObjectMembers([[maybe_unused]] std::vector<Object*>& objects) const noexcept -> void
 {
 
 }
@@ -63,7 +63,7 @@ auto Type::isPrimitiveType() const noexcept -> bool
            heldType() == runtime::types::Type::String;
 }
 
-auto Type::construct(std::span<runtime::Value> args) const -> runtime::Value
+auto Type::construct(std::span<runtime::Value> args) const -> runtime::Result<runtime::Value>
 {
     POISE_ASSERT(m_constructorFunction != nullptr, fmt::format("Constructor function not assigned for {}", heldType()));
     return m_constructorFunction(args);
@@ -11,14 +11,14 @@ namespace poise::objects {
 class Type : public Object
 {
 public:
-    using ConstructorFn = runtime::Value(*)(std::span<runtime::Value>);
+    using ConstructorFn = runtime::Result<runtime::Value>(*)(std::span<runtime::Value>);
 
     Type(runtime::types::Type type, std::string name, ConstructorFn constructorFunction);
     ~Type() override = default;
 
     [[nodiscard]] auto toString() const noexcept -> std::string override;
     [[nodiscard]] auto type() const noexcept -> runtime::types::Type override;
-    auto findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void override;
+    auto findObjectMembers(std::vector<Object*>& objects) const noexcept -> void override;
     auto removeObjectMembers() noexcept -> void override;
     [[nodiscard]] auto anyMemberMatchesRecursive(const Object* object) const noexcept -> bool override;
 
@@ -28,7 +28,7 @@ public:
     [[nodiscard]] auto typeName() const noexcept -> std::string_view;
     [[nodiscard]] auto isPrimitiveType() const noexcept -> bool;
 
-    [[nodiscard]] auto construct(std::span<runtime::Value>) const -> runtime::Value;
+    [[nodiscard]] auto construct(std::span<runtime::Value>) const -> runtime::Result<runtime::Value>;
 
     auto addExtensionFunction(runtime::Value extensionFunction) -> void;
     [[nodiscard]] auto findExtensionFunction(usize functionNameHash) const -> std::optional<runtime::Value>;
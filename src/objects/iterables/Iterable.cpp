@@ -29,7 +29,7 @@ auto Iterable::asIterable() noexcept -> Iterable*
     return this;
 }
 
-auto Iterable::findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void
+auto Iterable::findObjectMembers(std::vector<Object*>& objects) const noexcept -> void
 {
     if (type() == runtime::types::Type::Range) {
         return;
@@ -37,9 +37,7 @@ auto Iterable::findObjectMembers(std::unordered_set<Object*>& objects) const noe
 
     for (const auto& value : m_data) {
         if (const auto object = value.object()) {
-            if (const auto [it, inserted] = objects.insert(object); inserted) {
-                object->findObjectMembers(objects);
-            }
+            objects.push_back(object);
         }
     }
 }
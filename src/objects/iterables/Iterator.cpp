@@ -4,7 +4,11 @@
 
 #include "Iterator.hpp"
 #include "Iterable.hpp"
+#include "Range.hpp"
+#include "Tuple.hpp"
+#include "hashables/Dict.hpp"
 #include "../Exception.hpp"
+#include "../../runtime/memory/Gc.hpp"
 
 #include <fmt/format.h>
 
@@ -13,19 +17,27 @@ Iterator::Iterator(runtime::Value iterable)
     : m_iterableValue{std::move(iterable)}
     , m_iterablePtr{m_iterableValue.object()->asIterable()}
     , m_isValid{true}
+    , m_rangePtr{m_iterablePtr->asRange()}
+    , m_dictPtr{m_iterablePtr->asDictionary()}
 {
     // no need to increase reference count on the iterable
     // holding the Value does this
     m_iterablePtr->addIterator(this);
     m_iterator = m_iterablePtr->begin();
+    m_index = m_dictPtr != nullptr ? m_dictPtr->firstSlot() : 0_uz;
+    loadRangeValue();
 }
 
 Iterator::Iterator(Iterable* iterable)
     : m_iterablePtr{iterable}
     , m_isValid{true}
+    , m_rangePtr{m_iterablePtr->asRange()}
+    , m_dictPtr{m_iterablePtr->asDictionary()}
 {
     m_iterablePtr->addIterator(this);
     m_iterator = m_iterablePtr->begin();
+    m_index = m_dictPtr != nullptr ? m_dictPtr->firstSlot() : 0_uz;
+    loadRangeValue();
 }
 
 Iterator::~Iterator()
@@ -50,10 +62,15 @@ auto Iterator::type() const noexcept -> runtime::types::Type
     return runtime::types::Type::Iterator;
 }
 
-auto Iterator::findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void
+auto Iterator::findObjectMembers(std::vector<Object*>& objects) const noexcept -> void
 {
-    if (const auto [it, inserted] = objects.insert(m_iterablePtr); inserted) {
-        m_iterablePtr->findObjectMembers(objects);
+    if (m_iterablePtr != nullptr) {
+        objects.push_back(m_iterablePtr);
+    }
+
+    // the tuple for the current entry when iterating over a Dict
+    if (const auto object = m_indexedValue.object()) {
+        objects.push_back(object);
     }
 }
 
@@ -61,6 +78,9 @@ auto Iterator::removeObjectMembers() noexcept -> void
 {
     m_iterableValue = runtime::Value::none();
     m_iterablePtr = nullptr;
+    m_rangePtr = nullptr;
+    m_dictPtr = nullptr;
+    m_indexedValue = runtime::Value::none();
 }
 
 auto Iterator::anyMemberMatchesRecursive(const Object* object) const noexcept -> bool
@@ -75,7 +95,16 @@ auto Iterator::anyMemberMatchesRecursive(const Object* object) const noexcept ->
 auto Iterator::increment() -> void
 {
     throwIfInvalid();
-    m_iterablePtr->incrementIterator(m_iterator);
+
+    if (m_rangePtr != nullptr) {
+        m_index++;
+        loadRangeValue();
+    } else if (m_dictPtr != nullptr) {
+        m_index = m_dictPtr->nextSlot(m_index + 1_uz);
+        m_indexedValue = runtime::Value::none();
+    } else {
+        m_iterablePtr->incrementIterator(m_iterator);
+    }
 }
 
 auto Iterator::invalidate() noexcept -> void
@@ -85,6 +114,14 @@ auto Iterator::invalidate() noexcept -> void
 
 auto Iterator::isAtEnd() const noexcept -> bool
 {
+    if (m_rangePtr != nullptr) {
+        return m_index >= m_rangePtr->size();
+    }
+
+    if (m_dictPtr != nullptr) {
+        return m_index >= m_dictPtr->capacity();
+    }
+
     return m_iterablePtr->isAtEnd(m_iterator);
 }
 
@@ -96,7 +133,27 @@ auto Iterator::valid() const noexcept -> bool
 auto Iterator::value() const -> const runtime::Value&
 {
     throwIfInvalid();
-    return *m_iterator;
+
+    if (m_dictPtr != nullptr && m_indexedValue.type() == runtime::types::Type::None) {
+        m_indexedValue = runtime::Value::createObject<Tuple>(m_dictPtr->keyAt(m_index), m_dictPtr->valueAt(m_index));
+        if (!young()) {
+            runtime::memory::Gc::instance().rememberObject(m_indexedValue.object());
+        }
+    }
+
+    return isIndexed() ? m_indexedValue : *m_iterator;
+}
+
+auto Iterator::dictKey() const -> const runtime::Value&
+{
+    throwIfInvalid();
+    return m_dictPtr->keyAt(m_index);
+}
+
+auto Iterator::dictValue() const -> const runtime::Value&
+{
+    throwIfInvalid();
+    return m_dictPtr->valueAt(m_index);
 }
 
 auto Iterator::iterator() const noexcept -> const IteratorType&
@@ -109,6 +166,18 @@ auto Iterator::iterator() noexcept -> IteratorType&
     return m_iterator;
 }
 
+auto Iterator::loadRangeValue() noexcept -> void
+{
+    if (m_rangePtr != nullptr && !isAtEnd()) {
+        m_indexedValue = m_rangePtr->at(m_index);
+    }
+}
+
+auto Iterator::isIndexed() const noexcept -> bool
+{
+    return m_rangePtr != nullptr || m_dictPtr != nullptr;
+}
+
 auto Iterator::throwIfInvalid() const -> void
 {
     if (!valid()) {
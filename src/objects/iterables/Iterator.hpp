@@ -12,6 +12,11 @@
 
 namespace poise::objects::iterables {
 class Iterable;
+class Range;
+
+namespace hashables {
+class Dict;
+}   // namespace hashables
 
 class Iterator : public Object
 {
@@ -29,7 +34,7 @@ public:
 
     [[nodiscard]] auto toString() const noexcept -> std::string override;
     [[nodiscard]] auto type() const noexcept -> runtime::types::Type override;
-    auto findObjectMembers(std::unordered_set<Object*>& objects) const noexcept -> void override;
+    auto findObjectMembers(std::vector<Object*>& objects) const noexcept -> void override;
     auto removeObjectMembers() noexcept -> void override;
     [[nodiscard]] auto anyMemberMatchesRecursive(const Object* object) const noexcept -> bool override;
 
@@ -40,16 +45,28 @@ public:
     [[nodiscard]] auto iterator() const noexcept -> const IteratorType&;
     [[nodiscard]] auto iterator() noexcept -> IteratorType&;
     [[nodiscard]] auto value() const -> const runtime::Value&;
+    // the key and value of the current pair when iterating a Dict, without making a Tuple for them
+    [[nodiscard]] auto dictKey() const -> const runtime::Value&;
+    [[nodiscard]] auto dictValue() const -> const runtime::Value&;
     [[nodiscard]] auto iterableValue() const noexcept -> const runtime::Value&;
     [[nodiscard]] auto iterablePtr() const noexcept -> Iterable*;
 
 private:
+    auto loadRangeValue() noexcept -> void;
+    [[nodiscard]] auto isIndexed() const noexcept -> bool;
     auto throwIfInvalid() const -> void;
 
     runtime::Value m_iterableValue;
     Iterable* m_iterablePtr;
     IteratorType m_iterator;
     bool m_isValid;
+
+    // Ranges and Dicts have no data to point into, so iterating them goes through their indexes instead
+    Range* m_rangePtr;
+    hashables::Dict* m_dictPtr;
+    usize m_index{};
+    // the current value of a Range, or the (key, value) Tuple of a Dict once something has asked for it
+    mutable runtime::Value m_indexedValue;
 };
 } // namespace poise::objects::iterables
 
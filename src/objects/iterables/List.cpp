@@ -151,6 +151,7 @@ auto List::at(isize index) -> runtime::Value&
 
 auto List::append(runtime::Value value) noexcept -> void
 {
+    recordWrite(value);
     m_data.emplace_back(std::move(value));
     invalidateIterators();
 }
@@ -161,6 +162,7 @@ auto List::insert(usize index, runtime::Value value) noexcept -> bool
         return false;
     }
 
+    recordWrite(value);
     m_data.insert(m_data.begin() + static_cast<DifferenceType>(index), std::move(value));
     invalidateIterators();
     return true;
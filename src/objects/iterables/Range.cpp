@@ -7,6 +7,13 @@
 #include <fmt/format.h>
 
 namespace poise::objects::iterables {
+namespace {
+[[nodiscard]] auto magnitude(i64 value) noexcept -> u64
+{
+    return value < 0 ? 0_u64 - static_cast<u64>(value) : static_cast<u64>(value);
+}
+}   // namespace
+
 Range::Range(const runtime::Value& start, const runtime::Value& end, const runtime::Value& increment, bool inclusive)
     : m_inclusive{inclusive}
     , m_start{start.value<i64>()}
@@ -14,11 +21,16 @@ Range::Range(const runtime::Value& start, const runtime::Value& end, const runti
     , m_increment{increment.value<i64>()}
 {
     if ((m_start < m_end && m_increment > 0) || (m_end < m_start && m_increment < 0)) {
-        fillData(m_start, m_increment);
+        // the number of increments from the start to the last value in the range, plus the start itself
+        const auto last = m_inclusive ? m_end : (m_increment > 0 ? m_end - 1 : m_end + 1);
+        const auto distance = m_increment > 0
+            ? static_cast<u64>(last) - static_cast<u64>(m_start)
+            : static_cast<u64>(m_start) - static_cast<u64>(last);
+        m_size = static_cast<usize>(distance / magnitude(m_increment)) + 1_uz;
     } else {
         // otherwise no iteration is possible
         // either the increment is 0, or going in the other direction of start -> end
-        // so just don't fill the vector at all, begin == end, no iteration will happen if you try
+        // so the size is 0, no iteration will happen if you try
         m_isInfiniteLoop = true;
     }
 }
@@ -45,12 +57,7 @@ auto Range::iterable() const -> bool
 
 auto Range::size() const noexcept -> usize
 {
-    if (m_isInfiniteLoop) {
-        return 0_uz;
-    }
-
-    const auto range = m_start < m_end ? std::abs(m_end - m_start) : std::abs(m_start - m_end);
-    return static_cast<usize>(range / std::abs(m_increment));
+    return m_size;
 }
 
 auto Range::ssize() const noexcept -> isize
@@ -60,24 +67,12 @@ auto Range::ssize() const noexcept -> isize
 
 auto Range::unpack(std::vector<runtime::Value>& stack) const noexcept -> void
 {
-    if (m_isInfiniteLoop) {
-        stack.emplace_back(0);
-        stack.emplace_back(0);
-        return;
-    }
-
-    const auto upwards = m_end > m_start;
-    auto current = m_start;
-
-    for (;; current += m_increment) {
-        if (upwards ? (m_inclusive ? current > m_end : current >= m_end) : (m_inclusive ? current < m_end : current <= m_end)) {
-            break;
-        }
-
-        stack.emplace_back(current);
+    stack.reserve(stack.size() + m_size + 1_uz);
+    for (auto i = 0_uz; i < m_size; i++) {
+        stack.emplace_back(at(i));
     }
 
-    stack.emplace_back(size());
+    stack.emplace_back(m_size);
 }
 
 auto Range::begin() noexcept -> IteratorType
@@ -90,35 +85,14 @@ auto Range::end() noexcept -> IteratorType
     return m_data.end();
 }
 
-auto Range::incrementIterator(IteratorType& iterator) noexcept -> void
+auto Range::incrementIterator([[maybe_unused]] IteratorType& iterator) noexcept -> void
 {
-    ++iterator;
-
-    if (isAtEnd(iterator)) {
-        // exhausted the current data, check if we need to refill
-        if (!(m_inclusive && m_data.back() == m_end) && !(!m_inclusive && m_data.back() == m_end - m_increment)) {
-            std::vector<DifferenceType> iteratorIndexes;
-            iteratorIndexes.reserve(m_activeIterators.size());
-            for (auto i = 0_uz; i < m_activeIterators.size(); i++) {
-                iteratorIndexes.push_back(std::distance(m_data.begin(), m_activeIterators[i]->iterator()));
-            }
-
-            const auto value = m_data.back().toInt() + m_increment;
-            fillData(value, m_increment);
-
-            for (auto i = 0_uz; i < m_activeIterators.size(); i++) {
-                m_activeIterators[i]->iterator() = m_data.begin() + iteratorIndexes[i];
-            }
-        }
-    } else if ((m_inclusive && *iterator > m_end) || (!m_inclusive && *iterator >= m_end)) {
-        // the actual value has gone past the end of the range, so make it as if we're at the end
-        iterator = end();
-    }
+    POISE_UNREACHABLE();
 }
 
-auto Range::isAtEnd(const IteratorType& iterator) noexcept -> bool
+auto Range::isAtEnd([[maybe_unused]] const IteratorType& iterator) noexcept -> bool
 {
-    return iterator == end();
+    return true;
 }
 
 auto Range::isInfiniteLoop() const noexcept -> bool
@@ -146,37 +120,37 @@ auto Range::rangeInclusive() const noexcept -> runtime::Value
     return m_inclusive;
 }
 
-auto Range::fillData(i64 value, i64 increment) -> void
+auto Range::at(usize index) const noexcept -> i64
 {
-    const auto size = m_data.size();
-    m_data.resize(size + s_chunkSize);
-
-    for (auto i = size; i < m_data.size(); i++) {
-        m_data[i] = value;
-        value += increment;
-    }
+    POISE_ASSERT(index < m_size, "Range index out of bounds");
+    return static_cast<i64>(static_cast<u64>(m_start) + static_cast<u64>(index) * static_cast<u64>(m_increment));
 }
 
-auto Range::toVector() const noexcept -> std::vector<runtime::Value>
+auto Range::contains(const runtime::Value& value) const noexcept -> bool
 {
-    if (m_isInfiniteLoop) {
-        return {};
+    if (m_isInfiniteLoop || !value.isInt()) {
+        return false;
     }
 
-    std::vector<runtime::Value> res;
+    const auto i = value.value<i64>();
+    const auto last = at(m_size - 1_uz);
+    if (m_increment > 0 ? (i < m_start || i > last) : (i > m_start || i < last)) {
+        return false;
+    }
 
-    const auto upwards = m_end > m_start;
-    auto current = m_start;
+    const auto distance = m_increment > 0 ? static_cast<u64>(i) - static_cast<u64>(m_start) : static_cast<u64>(m_start) - static_cast<u64>(i);
+    return distance % magnitude(m_increment) == 0_u64;
+}
 
-    for (;; current += m_increment) {
-        if (upwards ? (m_inclusive ? current > m_end : current >= m_end) : (m_inclusive ? current < m_end : current <= m_end)) {
-            break;
-        }
+auto Range::toVector() const noexcept -> std::vector<runtime::Value>
+{
+    std::vector<runtime::Value> res;
+    res.reserve(m_size);
 
-        res.emplace_back(current);
+    for (auto i = 0_uz; i < m_size; i++) {
+        res.emplace_back(at(i));
     }
 
     return res;
 }
 }   // namespace poise::objects::iterables
- 
@@ -21,6 +21,7 @@ public:
     [[nodiscard]] auto type() const noexcept -> runtime::types::Type override;
     [[nodiscard]] auto iterable() const -> bool override;
 
+    // a Range holds no data, Iterators over it compute their values with at()
     [[nodiscard]] auto begin() noexcept -> IteratorType override;
     [[nodiscard]] auto end() noexcept -> IteratorType override;
     auto incrementIterator(IteratorType& iterator) noexcept -> void override;
@@ -36,16 +37,17 @@ public:
     [[nodiscard]] auto rangeIncrement() const noexcept -> runtime::Value;
     [[nodiscard]] auto rangeInclusive() const noexcept -> runtime::Value;
 
+    // index is required to be less than size()
+    [[nodiscard]] auto at(usize index) const noexcept -> i64;
+    [[nodiscard]] auto contains(const runtime::Value& value) const noexcept -> bool;
+
     [[nodiscard]] auto toVector() const noexcept -> std::vector<runtime::Value>;
 
 private:
-    static constexpr usize s_chunkSize = 8_uz;
-
-    auto fillData(i64 value, i64 increment) -> void;
-
     bool m_inclusive;
     i64 m_start, m_end, m_increment;
     bool m_isInfiniteLoop{};
+    usize m_size{};
 };
 }   // namespace poise::objects::iterables
 
@@ -3,9 +3,26 @@
 #include "../Tuple.hpp"
 
 #include <algorithm>
+#include <optional>
 
 namespace poise::objects::iterables::hashables {
+namespace {
+auto appendElement(std::string& res, const runtime::Value& value, const Object* dict) -> void
+{
+    if (value.object() && value.object()->anyMemberMatchesRecursive(dict)) {
+        res.append("...");
+    } else if (value.type() == runtime::types::Type::String) {
+        res.push_back('"');
+        res.append(value.string());
+        res.push_back('"');
+    } else {
+        res.append(value.toString());
+    }
+}
+}   // namespace
+
 Dict::Dict(std::span<runtime::Value> pairs)
+    : m_slots(s_initialCapacity)
 {
     for (auto& pair : pairs) {
         const auto tuple = pair.object()->asTuple();
@@ -17,13 +34,7 @@ Dict::Dict(std::span<runtime::Value> pairs)
 
 auto Dict::begin() noexcept -> IteratorType
 {
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied) {
-            return m_data.begin() + static_cast<isize>(i);
-        }
-    }
-
-    return end();
+    return m_data.begin();
 }
 
 auto Dict::end() noexcept -> IteratorType
@@ -31,26 +42,20 @@ auto Dict::end() noexcept -> IteratorType
     return m_data.end();
 }
 
-auto Dict::incrementIterator(IteratorType& iterator) noexcept -> void
+auto Dict::incrementIterator([[maybe_unused]] IteratorType& iterator) noexcept -> void
 {
-    usize index;
-    do {
-        ++iterator;
-        index = static_cast<usize>(std::distance(m_data.begin(), iterator));
-    } while (!isAtEnd(iterator) && m_cellStates[index] != CellState::Occupied);
+    POISE_UNREACHABLE();
 }
 
-auto Dict::isAtEnd(const IteratorType& iterator) noexcept -> bool
+auto Dict::isAtEnd([[maybe_unused]] const IteratorType& iterator) noexcept -> bool
 {
-    return iterator == end();
+    return true;
 }
 
 auto Dict::unpack(std::vector<runtime::Value>& stack) const noexcept -> void
 {
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied) {
-            stack.push_back(m_data[i]);
-        }
+    for (auto slot = firstSlot(); slot < capacity(); slot = nextSlot(slot + 1_uz)) {
+        stack.push_back(runtime::Value::createObject<Tuple>(m_slots[slot].key, m_slots[slot].value));
     }
 
     stack.emplace_back(size());
@@ -65,16 +70,12 @@ auto Dict::toString() const noexcept -> std::string
 {
     std::string res = "{";
     usize count = 0_uz;
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] != CellState::Occupied) {
-            continue;
-        }
-
-        if (m_data[i].object()->anyMemberMatchesRecursive(this)) {
-            res.append("(...)");
-        } else {
-            res.append(m_data[i].toString());
-        }
+    for (auto slot = firstSlot(); slot < capacity(); slot = nextSlot(slot + 1_uz)) {
+        res.push_back('(');
+        appendElement(res, m_slots[slot].key, this);
+        res.append(", ");
+        appendElement(res, m_slots[slot].value, this);
+        res.push_back(')');
 
         if (count++ < size() - 1_uz) {
             res.append(", ");
@@ -95,184 +96,185 @@ auto Dict::iterable() const -> bool
     return true;
 }
 
-auto Dict::containsKey(const runtime::Value& key) const noexcept -> bool
+auto Dict::findObjectMembers(std::vector<Object*>& objects) const noexcept -> void
 {
-    const auto hash = key.hash();
-    auto index = hash % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed:
-                return false;
-            case CellState::Occupied: {
-                if (const auto tuple = m_data[index].object()->asTuple(); tuple->at(0_uz) == key) {
-                    return true;
-                }
-
-                [[fallthrough]];
-            }
-            case CellState::Tombstone: {
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default: {
-                POISE_UNREACHABLE();
-            }
+    const auto findMembers = [&objects] (const runtime::Value& value) {
+        if (const auto object = value.object()) {
+            objects.push_back(object);
         }
+    };
+
+    for (auto slot = firstSlot(); slot < capacity(); slot = nextSlot(slot + 1_uz)) {
+        findMembers(m_slots[slot].key);
+        findMembers(m_slots[slot].value);
     }
 }
 
-auto Dict::at(const runtime::Value& key) const -> const runtime::Value&
+auto Dict::removeObjectMembers() noexcept -> void
 {
-    const auto hash = key.hash();
-    auto index = hash % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed:
-                throw Exception{
-                    Exception::ExceptionType::KeyNotFound,
-                    fmt::format("{} was not present in the Dict", key)
-                };
-            case CellState::Occupied: {
-                if (const auto& tuple = m_data[index].object()->asTuple(); tuple->at(0_uz) == key) {
-                    return tuple->at(1_uz);
-                }
-
-                [[fallthrough]];
-            }
-            case CellState::Tombstone: {
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default: {
-                POISE_UNREACHABLE();
-            }
+    for (auto& slot : m_slots) {
+        if (slot.key.object() != nullptr) {
+            slot.key = runtime::Value::none();
+        }
+
+        if (slot.value.object() != nullptr) {
+            slot.value = runtime::Value::none();
         }
     }
 }
 
-auto Dict::tryInsert(runtime::Value key, runtime::Value value) noexcept -> bool
+auto Dict::anyMemberMatchesRecursive(const Object* object) const noexcept -> bool
 {
-    const auto hash = key.hash();
-    auto index = hash % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed:
-            case CellState::Tombstone: {
-                addPair(index, true, std::move(key), std::move(value));
-                return true;
-            }
-            case CellState::Occupied: {
-                if (m_data[index].object()->asTuple()->at(0_uz) == key) {
-                    return false;
-                }
-
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default: {
-                POISE_UNREACHABLE();
-            }
+    const auto matches = [object, this] (const runtime::Value& value) -> bool {
+        const auto member = value.object();
+        return member != nullptr && (member == this || member == object || member->anyMemberMatchesRecursive(object));
+    };
+
+    for (auto slot = firstSlot(); slot < capacity(); slot = nextSlot(slot + 1_uz)) {
+        if (matches(m_slots[slot].key) || matches(m_slots[slot].value)) {
+            return true;
         }
     }
+
+    return false;
+}
+
+auto Dict::toVector() const noexcept -> std::vector<runtime::Value>
+{
+    std::vector<runtime::Value> res;
+    res.reserve(size());
+
+    for (auto slot = firstSlot(); slot < capacity(); slot = nextSlot(slot + 1_uz)) {
+        res.push_back(runtime::Value::createObject<Tuple>(m_slots[slot].key, m_slots[slot].value));
+    }
+
+    return res;
+}
+
+auto Dict::containsKey(const runtime::Value& key) const noexcept -> bool
+{
+    return findKey(key, mixHash(key.hash())).has_value();
+}
+
+auto Dict::at(const runtime::Value& key) const -> const runtime::Value&
+{
+    if (const auto value = find(key)) {
+        return *value;
+    }
+
+    throw Exception{
+        Exception::ExceptionType::KeyNotFound,
+        fmt::format("{} was not present in the Dict", key)
+    };
+}
+
+auto Dict::find(const runtime::Value& key) const noexcept -> const runtime::Value*
+{
+    const auto index = findKey(key, mixHash(key.hash()));
+    return index ? &m_slots[*index].value : nullptr;
+}
+
+auto Dict::tryInsert(runtime::Value key, runtime::Value value) noexcept -> bool
+{
+    const auto hash = mixHash(key.hash());
+    if (findKey(key, hash)) {
+        return false;
+    }
+
+    addPair(hash, std::move(key), std::move(value));
+    return true;
 }
 
 auto Dict::insertOrUpdate(runtime::Value key, runtime::Value value) noexcept -> void
 {
-    const auto hash = key.hash();
-    auto index = hash % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed:
-            case CellState::Tombstone: {
-                addPair(index, true, std::move(key), std::move(value));
-                return;
-            }
-            case CellState::Occupied: {
-                if (m_data[index].object()->asTuple()->at(0_uz) == key) {
-                    addPair(index, false, std::move(key), std::move(value));
-                    return;
-                }
-
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default: {
-                POISE_UNREACHABLE();
-            }
-        }
+    const auto hash = mixHash(key.hash());
+    if (const auto index = findKey(key, hash)) {
+        recordWrite(value);
+        m_slots[*index].value = std::move(value);
+        invalidateIterators();
+    } else {
+        addPair(hash, std::move(key), std::move(value));
     }
 }
 
 auto Dict::remove(const runtime::Value& key) noexcept -> bool
 {
-    const auto hash = key.hash();
-    auto index = hash % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed: {
-                return false;
-            }
-            case CellState::Occupied: {
-                if (m_data[index].object()->asTuple()->at(0_uz) == key) {
-                    m_data[index] = runtime::Value::none();
-                    m_cellStates[index] = CellState::Tombstone;
-                    m_size--;
-                    invalidateIterators();
-                    return true;
-                }
-
-                [[fallthrough]];
-            }
-            case CellState::Tombstone: {
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default: {
-                POISE_UNREACHABLE();
-            }
-        }
+    const auto index = findKey(key, mixHash(key.hash()));
+    if (!index) {
+        return false;
     }
+
+    m_slots[*index].key = runtime::Value::none();
+    m_slots[*index].value = runtime::Value::none();
+    erase(*index);
+    invalidateIterators();
+    return true;
 }
 
-auto Dict::growAndRehash() noexcept -> void
+auto Dict::nextSlot(usize index) const noexcept -> usize
 {
-    const auto pairs = toVector();
+    return nextFull(index);
+}
 
-    m_capacity *= 2_uz;
-    m_size = 0_uz;
-    m_data.resize(m_capacity);
-    m_cellStates.resize(m_capacity);
+auto Dict::firstSlot() const noexcept -> usize
+{
+    return nextSlot(0_uz);
+}
 
-    std::ranges::fill(m_data, runtime::Value::none());
-    std::ranges::fill(m_cellStates, CellState::NeverUsed);
+auto Dict::keyAt(usize slot) const noexcept -> const runtime::Value&
+{
+    POISE_ASSERT(isFull(slot), "Slot is not occupied");
+    return m_slots[slot].key;
+}
 
-    // these are things that were already in the dict, so there should be no duplicates
-    // but insertOrUpdate does less than tryInsert
-    for (auto& pair : pairs) {
-        const auto tuple = pair.object()->asTuple();
-        insertOrUpdate(std::move(tuple->atMut(0_uz)), std::move(tuple->atMut(1_uz)));
+auto Dict::valueAt(usize slot) const noexcept -> const runtime::Value&
+{
+    POISE_ASSERT(isFull(slot), "Slot is not occupied");
+    return m_slots[slot].value;
+}
+
+auto Dict::rehash(usize newCapacity) noexcept -> void
+{
+    std::vector<Slot> slots;
+    slots.reserve(size());
+    for (auto slot = firstSlot(); slot < capacity(); slot = nextSlot(slot + 1_uz)) {
+        slots.push_back(std::move(m_slots[slot]));
+    }
+
+    // these are things that were already in the dict, so there are no duplicates to look for,
+    // and the hashes are already known, tombstones are left behind
+    resetControl(newCapacity);
+    m_slots = std::vector<Slot>(newCapacity);
+
+    for (auto& slot : slots) {
+        const auto index = findFreeIndex(slot.hash);
+        occupy(index, slot.hash);
+        m_slots[index] = std::move(slot);
     }
 
     // no need to invalidate iterators, the caller will always do that
 }
 
-auto Dict::addPair(usize index, bool isNewKey, runtime::Value key, runtime::Value value) noexcept -> void
+auto Dict::findKey(const runtime::Value& key, usize hash) const noexcept -> std::optional<usize>
 {
-    m_data[index] = runtime::Value::createObject<Tuple>(std::move(key), std::move(value));
-    m_cellStates[index] = CellState::Occupied;
-    invalidateIterators();
+    return findIndex(hash, [this, &key, hash] (usize index) -> bool {
+        return m_slots[index].hash == hash && m_slots[index].key == key;
+    });
+}
 
-    if (isNewKey) {
-        m_size++;
-        if (static_cast<f32>(size()) / static_cast<f32>(capacity()) >= s_threshold) {
-            growAndRehash();
-        }
-    }
+auto Dict::addPair(usize hash, runtime::Value key, runtime::Value value) noexcept -> void
+{
+    const auto index = findFreeIndex(hash);
+    occupy(index, hash);
+
+    recordWrite(key);
+    recordWrite(value);
+
+    auto& slot = m_slots[index];
+    slot.hash = hash;
+    slot.key = std::move(key);
+    slot.value = std::move(value);
+    invalidateIterators();
+    rehashIfFull();
 }
 } // namespace poise::objects::iterables::hashables
-
@@ -12,6 +12,8 @@ public:
     explicit Dict(std::span<runtime::Value> pairs);
     ~Dict() override = default;
 
+    // a Dict holds its pairs in its own slots rather than the Iterable's data,
+    // Iterators over it walk the occupied slots with firstSlot() and nextSlot()
     [[nodiscard]] auto begin() noexcept -> IteratorType override;
     [[nodiscard]] auto end() noexcept -> IteratorType override;
     auto incrementIterator(IteratorType& iterator) noexcept -> void override;
@@ -24,20 +26,45 @@ public:
     [[nodiscard]] auto type() const noexcept -> runtime::types::Type override;
     [[nodiscard]] auto iterable() const -> bool override;
 
+    auto findObjectMembers(std::vector<Object*>& objects) const noexcept -> void override;
+    auto removeObjectMembers() noexcept -> void override;
+    [[nodiscard]] auto anyMemberMatchesRecursive(const Object* object) const noexcept -> bool override;
+
+    // the pairs as (key, value) Tuples
+    [[nodiscard]] auto toVector() const noexcept -> std::vector<runtime::Value> override;
+
     [[nodiscard]] auto containsKey(const runtime::Value& key) const noexcept -> bool;
     [[nodiscard]] auto at(const runtime::Value& key) const -> const runtime::Value&;
+    // nullptr if the key isn't present
+    [[nodiscard]] auto find(const runtime::Value& key) const noexcept -> const runtime::Value*;
 
     [[nodiscard]] auto tryInsert(runtime::Value key, runtime::Value value) noexcept -> bool;
     auto insertOrUpdate(runtime::Value key, runtime::Value value) noexcept -> void;
     [[nodiscard]] auto remove(const runtime::Value& key) noexcept -> bool;
-    
+
+    // the index of the first occupied slot at or after index, or capacity() if there are none
+    [[nodiscard]] auto nextSlot(usize index) const noexcept -> usize;
+    [[nodiscard]] auto firstSlot() const noexcept -> usize;
+    [[nodiscard]] auto keyAt(usize slot) const noexcept -> const runtime::Value&;
+    [[nodiscard]] auto valueAt(usize slot) const noexcept -> const runtime::Value&;
+
 protected:
-    auto growAndRehash() noexcept -> void override;
+    auto rehash(usize newCapacity) noexcept -> void override;
 
 private:
-    auto addPair(usize index, bool isNewKey, runtime::Value key, runtime::Value value) noexcept -> void;
+    // the key and value are stored inline with the key's mixed hash, so rehashing doesn't need to hash the keys again
+    struct Slot
+    {
+        usize hash{};
+        runtime::Value key;
+        runtime::Value value;
+    };
+
+    [[nodiscard]] auto findKey(const runtime::Value& key, usize hash) const noexcept -> std::optional<usize>;
+    auto addPair(usize hash, runtime::Value key, runtime::Value value) noexcept -> void;
+
+    std::vector<Slot> m_slots;
 };
-} // namespace poise::objects::iterables::hashables 
+} // namespace poise::objects::iterables::hashables
 
 #endif // #ifndef POISE_DICTIONARY_HPP
-
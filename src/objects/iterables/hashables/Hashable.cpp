@@ -2,17 +2,8 @@
 
 namespace poise::objects::iterables::hashables {
 Hashable::Hashable()
-    : Iterable{s_initialCapacity, runtime::Value::none()}
-    , m_cellStates(s_initialCapacity, CellState::NeverUsed)
 {
-
-}
-
-Hashable::Hashable(usize initialCapacity, const runtime::Value& defaultValue)
-    : Iterable{initialCapacity, defaultValue}
-    , m_cellStates(initialCapacity, CellState::NeverUsed)
-{
-
+    resetControl(s_initialCapacity);
 }
 
 auto Hashable::asHashable() noexcept -> Hashable*
@@ -35,18 +26,111 @@ auto Hashable::capacity() const noexcept -> usize
     return m_capacity;
 }
 
-auto Hashable::toVector() const noexcept -> std::vector<runtime::Value>
+auto Hashable::mixHash(usize hash) noexcept -> usize
 {
-    std::vector<runtime::Value> res;
-    res.reserve(size());
+    // the finaliser from MurmurHash3
+    auto h = static_cast<u64>(hash);
+    h ^= h >> 33_u64;
+    h *= 0xFF51'AFD7'ED55'8CCD_u64;
+    h ^= h >> 33_u64;
+    h *= 0xC4CE'B9FE'1A85'EC53_u64;
+    h ^= h >> 33_u64;
+    return static_cast<usize>(h);
+}
 
-    for (auto i = 0_uz; i < m_capacity; i++) {
-        if (m_cellStates[i] == CellState::Occupied) {
-            res.push_back(m_data[i]);
+auto Hashable::controlByte(usize hash) noexcept -> u8
+{
+    return static_cast<u8>(hash & 0x7F_uz);
+}
+
+auto Hashable::findFreeIndex(usize hash) const noexcept -> usize
+{
+    for (auto group = firstGroup(hash), step = 0_uz;; group = nextGroup(group, ++step)) {
+        const auto groupStart = group * s_groupWidth;
+        if (const auto bits = Group{m_control.data() + groupStart}.matchFree(); bits != 0_u32) {
+            return groupStart + static_cast<usize>(std::countr_zero(bits));
         }
     }
+}
+
+auto Hashable::occupy(usize index, usize hash) noexcept -> void
+{
+    POISE_ASSERT(!isFull(index), "Slot is already full");
 
-    return res;
+    if (m_control[index] == s_deleted) {
+        m_numTombstones--;
+    }
+
+    m_control[index] = controlByte(hash);
+    m_size++;
 }
-} // namespace poise::objects::iterables::hashables
 
+auto Hashable::erase(usize index) noexcept -> void
+{
+    POISE_ASSERT(isFull(index), "Slot is not full");
+
+    // if the group still has an empty slot, no probe has ever gone past it, so the slot can be empty again
+    const auto groupStart = index - index % s_groupWidth;
+    if (Group{m_control.data() + groupStart}.match(s_empty) != 0_u32) {
+        m_control[index] = s_empty;
+    } else {
+        m_control[index] = s_deleted;
+        m_numTombstones++;
+    }
+
+    m_size--;
+}
+
+auto Hashable::rehashIfFull() noexcept -> void
+{
+    if (static_cast<f32>(m_size + m_numTombstones) / static_cast<f32>(m_capacity) < s_threshold) {
+        return;
+    }
+
+    // if it's mostly tombstones, getting rid of them makes enough room without growing
+    const auto mostlyTombstones = static_cast<f32>(m_size) / static_cast<f32>(m_capacity) < s_threshold / 2.0f;
+    rehash(mostlyTombstones ? m_capacity : m_capacity * s_growFactor);
+}
+
+auto Hashable::isFull(usize index) const noexcept -> bool
+{
+    return (m_control[index] & 0x80_u8) == 0_u8;
+}
+
+auto Hashable::nextFull(usize index) const noexcept -> usize
+{
+    while (index < m_capacity && !isFull(index)) {
+        index++;
+    }
+
+    return index;
+}
+
+auto Hashable::resetControl(usize newCapacity) noexcept -> void
+{
+    POISE_ASSERT(std::has_single_bit(newCapacity), "Capacity must be a power of two");
+
+    m_capacity = newCapacity;
+    m_size = 0_uz;
+    m_numTombstones = 0_uz;
+
+    // a table smaller than a group still has a whole group of control bytes, the rest are sentinels
+    m_control.assign(std::max(newCapacity, s_groupWidth), s_sentinel);
+    std::fill_n(m_control.begin(), newCapacity, s_empty);
+}
+
+auto Hashable::numGroups() const noexcept -> usize
+{
+    return std::max(m_capacity / s_groupWidth, 1_uz);
+}
+
+auto Hashable::firstGroup(usize hash) const noexcept -> usize
+{
+    return (hash >> 7_uz) & (numGroups() - 1_uz);
+}
+
+auto Hashable::nextGroup(usize group, usize step) const noexcept -> usize
+{
+    return (group + step) & (numGroups() - 1_uz);
+}
+} // namespace poise::objects::iterables::hashables
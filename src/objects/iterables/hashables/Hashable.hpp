@@ -3,40 +3,140 @@
 
 #include "../Iterable.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <optional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POISE_HASHABLE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace poise::objects::iterables::hashables {
 class Hashable : public Iterable
 {
 public:
     Hashable();
-    explicit Hashable(usize initialCapacity, const runtime::Value& defaultValue = runtime::Value::none());
 
     [[nodiscard]] auto asHashable() noexcept -> Hashable* override;
 
     [[nodiscard]] auto size() const noexcept -> usize override;
     [[nodiscard]] auto ssize() const noexcept -> isize override;
     [[nodiscard]] auto capacity() const noexcept -> usize;
-    [[nodiscard]] auto toVector() const noexcept -> std::vector<runtime::Value>;
+    [[nodiscard]] virtual auto toVector() const noexcept -> std::vector<runtime::Value> = 0;
 
+    // the capacity is always a power of two
     static constexpr auto s_initialCapacity = 8_uz;
     static constexpr auto s_growFactor = 2_uz;
     static constexpr auto s_threshold = 0.75f;
 
 protected:
-    virtual auto growAndRehash() noexcept -> void = 0;
-    
-    enum class CellState
+    // rehashes into a table of newCapacity, which is the same capacity if there were only tombstones to get rid of
+    virtual auto rehash(usize newCapacity) noexcept -> void = 0;
+
+    /*
+        each slot has a control byte, either the low 7 bits of the hash of the value in it, or one of these
+        the control bytes are probed a group at a time, so a lookup compares against 16 slots at once
+        and only has to compare values for slots with matching control bytes
+        groups are aligned, a table smaller than a group pads the group out with sentinels that never match
+    */
+    static constexpr auto s_empty = u8{0x80};
+    static constexpr auto s_deleted = u8{0xFE};
+    static constexpr auto s_sentinel = u8{0xFF};
+    static constexpr auto s_groupWidth = 16_uz;
+
+    class Group
     {
-        NeverUsed,
-        Occupied,
-        Tombstone,
+    public:
+        explicit Group(const u8* control) noexcept
+        {
+#ifdef POISE_HASHABLE_SSE2
+            m_control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+#else
+            std::copy_n(control, s_groupWidth, m_control);
+#endif
+        }
+
+        // a bit set for each slot in the group whose control byte is controlByte
+        [[nodiscard]] auto match(u8 controlByte) const noexcept -> u32
+        {
+#ifdef POISE_HASHABLE_SSE2
+            return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_control, _mm_set1_epi8(static_cast<char>(controlByte)))));
+#else
+            auto bits = 0_u32;
+            for (auto i = 0_uz; i < s_groupWidth; i++) {
+                if (m_control[i] == controlByte) {
+                    bits |= 1_u32 << i;
+                }
+            }
+            return bits;
+#endif
+        }
+
+        [[nodiscard]] auto matchFree() const noexcept -> u32
+        {
+            return match(s_empty) | match(s_deleted);
+        }
+
+    private:
+#ifdef POISE_HASHABLE_SSE2
+        __m128i m_control;
+#else
+        u8 m_control[s_groupWidth];
+#endif
     };
 
+    // spreads the bits of Value::hash(), which is the identity for Ints on some platforms
+    [[nodiscard]] static auto mixHash(usize hash) noexcept -> usize;
+    [[nodiscard]] static auto controlByte(usize hash) noexcept -> u8;
+
+    // calls matches(index) for each full slot whose control byte matches the hash along its probe sequence,
+    // returning the first index it accepts, or nullopt once a group with an empty slot is reached
+    template<typename Matches>
+    [[nodiscard]] auto findIndex(usize hash, Matches matches) const noexcept -> std::optional<usize>
+    {
+        const auto byte = controlByte(hash);
+        for (auto group = firstGroup(hash), step = 0_uz;; group = nextGroup(group, ++step)) {
+            const auto groupStart = group * s_groupWidth;
+            const Group controlGroup{m_control.data() + groupStart};
+
+            for (auto bits = controlGroup.match(byte); bits != 0_u32; bits &= bits - 1_u32) {
+                if (const auto index = groupStart + static_cast<usize>(std::countr_zero(bits)); matches(index)) {
+                    return index;
+                }
+            }
+
+            if (controlGroup.match(s_empty) != 0_u32) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // the first empty or deleted slot along the probe sequence of the hash
+    [[nodiscard]] auto findFreeIndex(usize hash) const noexcept -> usize;
+    // marks a free slot as holding a value with this hash
+    auto occupy(usize index, usize hash) noexcept -> void;
+    auto erase(usize index) noexcept -> void;
+    // called after a value has been inserted, rehashes if the full and deleted slots are over the threshold
+    auto rehashIfFull() noexcept -> void;
+    [[nodiscard]] auto isFull(usize index) const noexcept -> bool;
+    // the first full slot at or after index, or capacity() if there are none
+    [[nodiscard]] auto nextFull(usize index) const noexcept -> usize;
+    // empties every slot, for the subclass's rehash
+    auto resetControl(usize newCapacity) noexcept -> void;
+
     usize m_size{};
     usize m_capacity = s_initialCapacity;
+    usize m_numTombstones{};
+
+private:
+    [[nodiscard]] auto numGroups() const noexcept -> usize;
+    [[nodiscard]] auto firstGroup(usize hash) const noexcept -> usize;
+    // triangular probing over the groups, which visits every group since the number of groups is a power of two
+    [[nodiscard]] auto nextGroup(usize group, usize step) const noexcept -> usize;
 
-    std::vector<CellState> m_cellStates;
+    std::vector<u8> m_control;
 };
 } // namespace poise::objects::iterables::hashables
 
 #endif  // #ifndef POISE_HASHABLE_HPP
-
@@ -4,7 +4,13 @@
 #include <ranges>
 
 namespace poise::objects::iterables::hashables {
+Set::Set()
+{
+    m_data.resize(s_initialCapacity);
+}
+
 Set::Set(std::span<runtime::Value> data)
+    : Set{}
 {
     for (auto& value : data) {
         tryInsert(std::move(value));
@@ -12,6 +18,7 @@ Set::Set(std::span<runtime::Value> data)
 }
 
 Set::Set(runtime::Value value)
+    : Set{}
 {
     switch (value.type()) {
         case runtime::types::Type::Dict:
@@ -25,8 +32,8 @@ Set::Set(runtime::Value value)
         }
         case runtime::types::Type::Range: {
             const auto range = value.object()->asRange();
-            for (const auto values = range->toVector(); const auto& v : values) {
-                tryInsert(v);
+            for (auto i = 0_uz; i < range->size(); i++) {
+                tryInsert(range->at(i));
             }
 
             break;
@@ -56,13 +63,7 @@ Set::Set(runtime::Value value)
 
 auto Set::begin() noexcept -> IteratorType
 {
-    for (auto i = 0_uz; i < size(); i++) {
-        if (m_cellStates[i] == CellState::Occupied) {
-            return m_data.begin() + static_cast<isize>(i);
-        }
-    }
-
-    return end();
+    return m_data.begin() + static_cast<isize>(nextFull(0_uz));
 }
 
 auto Set::end() noexcept -> IteratorType
@@ -72,11 +73,8 @@ auto Set::end() noexcept -> IteratorType
 
 auto Set::incrementIterator(IteratorType& iterator) noexcept -> void
 {
-    usize index;
-    do {
-        ++iterator;
-        index = static_cast<usize>(std::distance(m_data.begin(), iterator));
-    } while (!isAtEnd(iterator) && m_cellStates[index] != CellState::Occupied);
+    const auto index = static_cast<usize>(std::distance(m_data.begin(), iterator));
+    iterator = m_data.begin() + static_cast<isize>(nextFull(index + 1_uz));
 }
 
 auto Set::isAtEnd(const IteratorType& iterator) noexcept -> bool
@@ -86,16 +84,13 @@ auto Set::isAtEnd(const IteratorType& iterator) noexcept -> bool
 
 auto Set::unpack(std::vector<runtime::Value>& stack) const noexcept -> void
 {
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied) {
-            stack.push_back(m_data[i]);
-        }
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        stack.push_back(m_data[i]);
     }
 
     stack.emplace_back(size());
 }
 
-
 auto Set::asSet() noexcept -> Set*
 {
     return this;
@@ -105,11 +100,7 @@ auto Set::toString() const noexcept -> std::string
 {
     std::string res = "{";
     usize count = 0_uz;
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] != CellState::Occupied) {
-            continue;
-        }
-
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
         if (m_data[i].object() && m_data[i].object()->anyMemberMatchesRecursive(this)) {
             res.append("...");
         } else {
@@ -135,85 +126,50 @@ auto Set::iterable() const -> bool
     return true;
 }
 
-[[nodiscard]] auto Set::contains(const runtime::Value& value) const noexcept -> bool
+auto Set::toVector() const noexcept -> std::vector<runtime::Value>
 {
-    auto index = value.hash() % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed: {
-                return false;
-            }
-            case CellState::Occupied: {
-                if (m_data[index] == value) {
-                    return true;
-                }
+    std::vector<runtime::Value> res;
+    res.reserve(size());
 
-                [[fallthrough]];
-            }
-            case CellState::Tombstone: {
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default:
-                POISE_UNREACHABLE();
-        }
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        res.push_back(m_data[i]);
     }
+
+    return res;
 }
 
-auto Set::tryInsert(runtime::Value value) noexcept -> bool
+auto Set::contains(const runtime::Value& value) const noexcept -> bool
 {
-    auto index = value.hash() % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::Tombstone:
-            case CellState::NeverUsed: {
-                addValue(index, std::move(value));
-                return true;
-            }
-            case CellState::Occupied: {
-                if (m_data[index] == value) {
-                    return false;
-                }
+    return findValue(value, mixHash(value.hash())).has_value();
+}
 
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default:
-                POISE_UNREACHABLE();
-        }
+auto Set::tryInsert(runtime::Value value) noexcept -> bool
+{
+    const auto hash = mixHash(value.hash());
+    if (findValue(value, hash)) {
+        return false;
     }
+
+    const auto index = findFreeIndex(hash);
+    occupy(index, hash);
+    recordWrite(value);
+    m_data[index] = std::move(value);
+    invalidateIterators();
+    rehashIfFull();
+    return true;
 }
 
 auto Set::remove(const runtime::Value& value) noexcept -> bool
 {
-    auto index = value.hash() % capacity();
-
-    while (true) {
-        switch (m_cellStates[index]) {
-            case CellState::NeverUsed: {
-                return false;
-            }
-            case CellState::Occupied: {
-                if (m_data[index] == value) {
-                    m_data[index] = runtime::Value::none();
-                    m_cellStates[index] = CellState::Tombstone;
-                    m_size--;
-                    invalidateIterators();
-                    return true;
-                }
-
-                [[fallthrough]];
-            }
-            case CellState::Tombstone: {
-                index = (index + 1_uz) % capacity();
-                break;
-            }
-            default:
-                POISE_UNREACHABLE();
-        }
+    const auto index = findValue(value, mixHash(value.hash()));
+    if (!index) {
+        return false;
     }
+
+    m_data[*index] = runtime::Value::none();
+    erase(*index);
+    invalidateIterators();
+    return true;
 }
 
 auto Set::isSubset(const Set& other) const noexcept -> bool
@@ -222,8 +178,8 @@ auto Set::isSubset(const Set& other) const noexcept -> bool
         return true;
     }
 
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied && !other.contains(m_data[i])) {
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        if (!other.contains(m_data[i])) {
             return false;
         }
     }
@@ -237,8 +193,8 @@ auto Set::isSuperset(const Set& other) const noexcept -> bool
         return true;
     }
 
-    for (auto i = 0_uz; i < other.capacity(); i++) {
-        if (other.m_cellStates[i] == CellState::Occupied && !contains(other.m_data[i])) {
+    for (auto i = other.nextFull(0_uz); i < other.capacity(); i = other.nextFull(i + 1_uz)) {
+        if (!contains(other.m_data[i])) {
             return false;
         }
     }
@@ -251,16 +207,12 @@ auto Set::unionWith(const Set& other) const noexcept -> runtime::Value
     auto value = runtime::Value::createObject<Set>();
     const auto newSet = value.object()->asSet();
 
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied) {
-            newSet->tryInsert(m_data[i]);
-        }
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        newSet->tryInsert(m_data[i]);
     }
 
-    for (auto i = 0_uz; i < other.capacity(); i++) {
-        if (other.m_cellStates[i] == CellState::Occupied) {
-            newSet->tryInsert(other.m_data[i]);
-        }
+    for (auto i = other.nextFull(0_uz); i < other.capacity(); i = other.nextFull(i + 1_uz)) {
+        newSet->tryInsert(other.m_data[i]);
     }
 
     return value;
@@ -271,14 +223,14 @@ auto Set::intersection(const Set& other) const noexcept -> runtime::Value
     auto value = runtime::Value::createObject<Set>();
     const auto newSet = value.object()->asSet();
 
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied && other.contains(m_data[i])) {
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        if (other.contains(m_data[i])) {
             newSet->tryInsert(m_data[i]);
         }
     }
 
-    for (auto i = 0_uz; i < other.capacity(); i++) {
-        if (other.m_cellStates[i] == CellState::Occupied && contains(other.m_data[i])) {
+    for (auto i = other.nextFull(0_uz); i < other.capacity(); i = other.nextFull(i + 1_uz)) {
+        if (contains(other.m_data[i])) {
             newSet->tryInsert(other.m_data[i]);
         }
     }
@@ -291,8 +243,8 @@ auto Set::difference(const Set& other) const noexcept -> runtime::Value
     auto value = runtime::Value::createObject<Set>();
     const auto newSet = value.object()->asSet();
 
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied && !other.contains(m_data[i])) {
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        if (!other.contains(m_data[i])) {
             newSet->tryInsert(m_data[i]);
         }
     }
@@ -305,14 +257,14 @@ auto Set::symmetricDifference(const Set& other) const noexcept -> runtime::Value
     auto value = runtime::Value::createObject<Set>();
     const auto newSet = value.object()->asSet();
 
-    for (auto i = 0_uz; i < capacity(); i++) {
-        if (m_cellStates[i] == CellState::Occupied && !other.contains(m_data[i])) {
+    for (auto i = nextFull(0_uz); i < capacity(); i = nextFull(i + 1_uz)) {
+        if (!other.contains(m_data[i])) {
             newSet->tryInsert(m_data[i]);
         }
     }
 
-    for (auto i = 0_uz; i < other.capacity(); i++) {
-        if (other.m_cellStates[i] == CellState::Occupied && !contains(other.m_data[i])) {
+    for (auto i = other.nextFull(0_uz); i < other.capacity(); i = other.nextFull(i + 1_uz)) {
+        if (!contains(other.m_data[i])) {
             newSet->tryInsert(other.m_data[i]);
         }
     }
@@ -320,33 +272,26 @@ auto Set::symmetricDifference(const Set& other) const noexcept -> runtime::Value
     return value;     
 } 
 
-auto Set::growAndRehash() noexcept -> void
+auto Set::rehash(usize newCapacity) noexcept -> void
 {
     auto values = toVector();
 
-    m_capacity *= 2_uz;
-    m_size = 0_uz;
-    m_data.resize(m_capacity);
-    m_cellStates.resize(m_capacity);
-
-    std::ranges::fill(m_data, runtime::Value::none());
-    std::ranges::fill(m_cellStates, CellState::NeverUsed);
+    // the values are already unique, so they only need a free slot, and tombstones are left behind
+    resetControl(newCapacity);
+    m_data = std::vector<runtime::Value>(newCapacity);
 
     for (auto& value : values) {
-        tryInsert(std::move(value));
+        const auto hash = mixHash(value.hash());
+        const auto index = findFreeIndex(hash);
+        occupy(index, hash);
+        m_data[index] = std::move(value);
     }
 }
 
-auto Set::addValue(usize index, runtime::Value value) noexcept -> void
+auto Set::findValue(const runtime::Value& value, usize hash) const noexcept -> std::optional<usize>
 {
-    m_size++;
-    m_data[index] = std::move(value);
-    m_cellStates[index] = CellState::Occupied;
-    invalidateIterators();
-
-    if (static_cast<f32>(size()) / static_cast<f32>(capacity()) >= s_threshold) {
-        growAndRehash();
-    }
+    return findIndex(hash, [this, &value] (usize index) -> bool {
+        return m_data[index] == value;
+    });
 }
 } // namespace poise::objects::iterables::hashables
-
@@ -7,7 +7,7 @@ namespace poise::objects::iterables::hashables {
 class Set : public Hashable
 {
 public:
-    Set() = default;
+    Set();
     explicit Set(std::span<runtime::Value> data);
     explicit Set(runtime::Value value);
 
@@ -23,6 +23,8 @@ public:
     [[nodiscard]] auto type() const noexcept -> runtime::types::Type override;
     [[nodiscard]] auto iterable() const -> bool override;
 
+    [[nodiscard]] auto toVector() const noexcept -> std::vector<runtime::Value> override;
+
     [[nodiscard]] auto contains(const runtime::Value& value) const noexcept -> bool;
     auto tryInsert(runtime::Value value) noexcept -> bool;
     [[nodiscard]] auto remove(const runtime::Value& value) noexcept -> bool;
@@ -36,10 +38,11 @@ public:
     [[nodiscard]] auto symmetricDifference(const Set& other) const noexcept -> runtime::Value;
 
 protected:
-    auto growAndRehash() noexcept -> void override;
+    auto rehash(usize newCapacity) noexcept -> void override;
 
 private:
-    auto addValue(usize index, runtime::Value value) noexcept -> void;
+    // the values are stored in the Iterable's data, which has a slot for every control byte
+    [[nodiscard]] auto findValue(const runtime::Value& value, usize hash) const noexcept -> std::optional<usize>;
 };
 } // namespace poise::objects::iterables::hashables
 
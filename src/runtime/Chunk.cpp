@@ -0,0 +1,217 @@
+#include "Chunk.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+
+namespace poise::runtime {
+namespace {
+[[nodiscard]] auto superinstruction(Op first, Op second) noexcept -> std::optional<Op>
+{
+    // the operands of the fused op are the operands of the first op followed by the operands of the second,
+    // so the fused op can simply replace the first op and the second op's operands are emitted as usual
+    switch (first) {
+        case Op::LoadLocal:
+            switch (second) {
+                case Op::LoadConstant:
+                    return Op::LoadLocalLoadConstant;
+                case Op::LoadLocal:
+                    return Op::LoadLocalLoadLocal;
+                default:
+                    return std::nullopt;
+            }
+        case Op::LessThan:
+            return second == Op::JumpIfFalse ? std::optional{Op::LessThanJumpIfFalse} : std::nullopt;
+        default:
+            return std::nullopt;
+    }
+}
+}   // namespace
+
+auto MemberCache::find(types::Type receiverType) const noexcept -> const Value*
+{
+    for (auto i = 0_uz; i < size; i++) {
+        if (entries[i].receiverType == receiverType) {
+            return &entries[i].function;
+        }
+    }
+
+    return nullptr;
+}
+
+auto MemberCache::add(types::Type receiverType, Value function) noexcept -> void
+{
+    if (size < capacity) {
+        entries[size++] = {receiverType, std::move(function)};
+    }
+}
+
+auto Chunk::emitOp(Op op, usize line) noexcept -> void
+{
+    // can't fuse over a jump target, something would be jumping into the middle of the superinstruction
+    if (!m_opLocations.empty() && !endIsJumpTarget()) {
+        const auto lastOffset = m_opLocations.back().offset;
+        if (const auto fused = superinstruction(static_cast<Op>(m_code[lastOffset]), op)) {
+            m_code[lastOffset] = static_cast<u8>(*fused);
+            return;
+        }
+    }
+
+    m_opLocations.push_back({m_code.size(), line});
+    m_code.push_back(static_cast<u8>(op));
+}
+
+auto Chunk::markJumpTarget() noexcept -> usize
+{
+    m_lastJumpTarget = m_code.size();
+    return m_code.size();
+}
+
+auto Chunk::endIsJumpTarget() const noexcept -> bool
+{
+    return m_lastJumpTarget == m_code.size();
+}
+
+auto Chunk::removeLastOp() noexcept -> bool
+{
+    if (m_opLocations.empty()) {
+        return false;
+    }
+
+    const auto offset = m_opLocations.back().offset;
+    if (m_lastJumpTarget && *m_lastJumpTarget > offset) {
+        return false;
+    }
+
+    m_code.resize(offset);
+    m_opLocations.pop_back();
+    return true;
+}
+
+auto Chunk::addConstant(Value value) noexcept -> u32
+{
+    m_constants.emplace_back(std::move(value));
+    return static_cast<u32>(m_constants.size() - 1_uz);
+}
+
+auto Chunk::addMemberCache() noexcept -> u32
+{
+    m_memberCaches.emplace_back();
+    return static_cast<u32>(m_memberCaches.size() - 1_uz);
+}
+
+auto Chunk::memberCache(u32 index) noexcept -> MemberCache&
+{
+    POISE_ASSERT(index < m_memberCaches.size(), "Member cache out of range, there has been an error in codegen");
+    return m_memberCaches[index];
+}
+
+auto Chunk::addExceptionHandler(ExceptionHandler handler) noexcept -> void
+{
+    m_exceptionHandlers.push_back(handler);
+}
+
+auto Chunk::findExceptionHandler(usize offset) const noexcept -> const ExceptionHandler*
+{
+    const auto it = std::ranges::find_if(m_exceptionHandlers, [offset] (const ExceptionHandler& handler) -> bool {
+        return handler.start <= offset && offset < handler.end;
+    });
+
+    return it == m_exceptionHandlers.end() ? nullptr : &*it;
+}
+
+auto Chunk::code() const noexcept -> std::span<const u8>
+{
+    return m_code;
+}
+
+auto Chunk::code() noexcept -> std::span<u8>
+{
+    return m_code;
+}
+
+auto Chunk::size() const noexcept -> usize
+{
+    return m_code.size();
+}
+
+auto Chunk::constants() const noexcept -> std::span<const Value>
+{
+    return m_constants;
+}
+
+auto Chunk::numConstants() const noexcept -> usize
+{
+    return m_constants.size();
+}
+
+auto Chunk::opFromBack(usize index) const noexcept -> std::optional<Op>
+{
+    if (index >= m_opLocations.size()) {
+        return std::nullopt;
+    }
+
+    return static_cast<Op>(m_code[m_opLocations[m_opLocations.size() - 1_uz - index].offset]);
+}
+
+auto Chunk::lastOp() const noexcept -> std::optional<Op>
+{
+    return opFromBack(0_uz);
+}
+
+auto Chunk::lastOpOffset() const noexcept -> std::optional<usize>
+{
+    if (m_opLocations.empty()) {
+        return std::nullopt;
+    }
+
+    return m_opLocations.back().offset;
+}
+
+auto Chunk::lineAt(usize offset) const noexcept -> usize
+{
+    // find the last op that starts at or before the offset, that is the op the offset belongs to
+    const auto it = std::ranges::upper_bound(m_opLocations, offset, {}, &OpLocation::offset);
+    return it == m_opLocations.begin() ? 0_uz : std::prev(it)->line;
+}
+
+auto Chunk::print() const -> void
+{
+    fmt::print("Ops:\n");
+    for (const auto [offset, line] : m_opLocations) {
+        const auto op = static_cast<Op>(m_code[offset]);
+        fmt::print("\t{}: {}", offset, op);
+
+        const u8* operand = m_code.data() + offset + 1_uz;
+        for (const auto width : operandWidths(op)) {
+            switch (width) {
+                case 1:
+                    fmt::print(" {}", readOperand<u8>(operand));
+                    break;
+                case 4:
+                    fmt::print(" {}", readOperand<u32>(operand));
+                    break;
+                case 8:
+                    fmt::print(" {}", readOperand<u64>(operand));
+                    break;
+                default:
+                    POISE_UNREACHABLE();
+            }
+        }
+
+        fmt::print(" at line {}\n", line);
+    }
+
+    if (!m_exceptionHandlers.empty()) {
+        fmt::print("Exception handlers:\n");
+        for (const auto [start, end, target, numLocals, numHeldIterators] : m_exceptionHandlers) {
+            fmt::print("\t{}..{} -> {} with {} locals and {} iterators\n", start, end, target, numLocals, numHeldIterators);
+        }
+    }
+
+    fmt::print("Constants:\n");
+    for (auto i = 0_uz; i < m_constants.size(); i++) {
+        fmt::print("\t{}: {}\n", i, m_constants[i]);
+    }
+}
+}   // namespace poise::runtime
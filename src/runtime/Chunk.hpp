@@ -0,0 +1,135 @@
+#ifndef POISE_CHUNK_HPP
+#define POISE_CHUNK_HPP
+
+#include "../Poise.hpp"
+
+#include "Op.hpp"
+#include "Value.hpp"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace poise::runtime {
+template<typename T>
+concept Operand = std::is_integral_v<T>;
+
+// reads an immediate operand from the code stream and advances the cursor past it
+template<Operand T>
+[[nodiscard]] inline auto readOperand(const u8*& cursor) noexcept -> T
+{
+    T operand;
+    std::memcpy(&operand, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return operand;
+}
+
+// the extension functions a LoadMember has resolved, keyed on the type of the value they were loaded from
+// extension functions are all added at compile time, so an entry never goes stale
+struct MemberCache
+{
+    static constexpr auto capacity = 4_uz;
+
+    struct Entry
+    {
+        types::Type receiverType;
+        Value function;
+    };
+
+    std::array<Entry, capacity> entries{};
+    usize size{};
+
+    [[nodiscard]] auto find(types::Type receiverType) const noexcept -> const Value*;
+    // once it is full the site is megamorphic, later types are just looked up every time
+    auto add(types::Type receiverType, Value function) noexcept -> void;
+};
+
+class Chunk
+{
+public:
+    struct OpLocation
+    {
+        usize offset;
+        usize line;
+    };
+
+    // a try block, nothing happens at run time when one is entered, the vm only looks for
+    // the handler covering the op that raised an exception once one has actually been raised
+    struct ExceptionHandler
+    {
+        usize start;    // the code covered by the try block, end is exclusive
+        usize end;
+        usize target;   // the start of the catch block
+        u32 numLocals;  // the stack is truncated to the frame's first numLocals locals
+        u32 numHeldIterators;   // and the frame's held iterators to the ones from loops around the try block
+    };
+
+    // emits an op, or fuses it into the previous op if the pair has a superinstruction
+    auto emitOp(Op op, usize line) noexcept -> void;
+    // marks the current end of the code as the target of a jump, the next op will not be fused into the previous one
+    [[nodiscard]] auto markJumpTarget() noexcept -> usize;
+    // whether anything jumps to the end of the code, only the end can be checked since the code grows past older targets
+    [[nodiscard]] auto endIsJumpTarget() const noexcept -> bool;
+
+    template<Operand T>
+    auto emitOperand(T operand) noexcept -> void
+    {
+        const auto offset = m_code.size();
+        m_code.resize(offset + sizeof(T));
+        std::memcpy(m_code.data() + offset, &operand, sizeof(T));
+    }
+
+    template<Operand T>
+    auto patchOperand(usize offset, T operand) noexcept -> void
+    {
+        POISE_ASSERT(offset + sizeof(T) <= m_code.size(), "Operand out of range, there has been an error in codegen");
+        std::memcpy(m_code.data() + offset, &operand, sizeof(T));
+    }
+
+    template<Operand T>
+    [[nodiscard]] auto operandAt(usize offset) const noexcept -> T
+    {
+        POISE_ASSERT(offset + sizeof(T) <= m_code.size(), "Operand out of range, there has been an error in codegen");
+        const u8* cursor = m_code.data() + offset;
+        return readOperand<T>(cursor);
+    }
+
+    // removes the most recently emitted op and its operands, unless something jumps to the code after its start
+    [[nodiscard]] auto removeLastOp() noexcept -> bool;
+
+    [[nodiscard]] auto addConstant(Value value) noexcept -> u32;
+    [[nodiscard]] auto addMemberCache() noexcept -> u32;
+    [[nodiscard]] auto memberCache(u32 index) noexcept -> MemberCache&;
+    // handlers must be added innermost first, which they are since an inner try block ends before an outer one
+    auto addExceptionHandler(ExceptionHandler handler) noexcept -> void;
+    [[nodiscard]] auto findExceptionHandler(usize offset) const noexcept -> const ExceptionHandler*;
+
+    [[nodiscard]] auto code() const noexcept -> std::span<const u8>;
+    // mutable so the vm can quicken ops in place
+    [[nodiscard]] auto code() noexcept -> std::span<u8>;
+    [[nodiscard]] auto size() const noexcept -> usize;
+    [[nodiscard]] auto constants() const noexcept -> std::span<const Value>;
+    [[nodiscard]] auto numConstants() const noexcept -> usize;
+
+    // the op emitted `index` ops before the most recent one, 0 being the most recent
+    [[nodiscard]] auto opFromBack(usize index) const noexcept -> std::optional<Op>;
+    [[nodiscard]] auto lastOp() const noexcept -> std::optional<Op>;
+    [[nodiscard]] auto lastOpOffset() const noexcept -> std::optional<usize>;
+    [[nodiscard]] auto lineAt(usize offset) const noexcept -> usize;
+
+    auto print() const -> void;
+
+private:
+    std::vector<u8> m_code;
+    std::vector<Value> m_constants;
+    std::vector<MemberCache> m_memberCaches;
+    std::vector<ExceptionHandler> m_exceptionHandlers;
+    std::vector<OpLocation> m_opLocations;
+    std::optional<usize> m_lastJumpTarget;
+};  // class Chunk
+}   // namespace poise::runtime
+
+#endif  // #ifndef POISE_CHUNK_HPP
@@ -17,7 +17,7 @@ auto NativeFunction::arity() const noexcept -> u8
     return m_arity;
 }
 
-auto NativeFunction::operator()(std::span<Value> args) const -> Value
+auto NativeFunction::operator()(std::span<Value> args) const -> Result<Value>
 {
     return m_function(args);
 }
@@ -6,6 +6,7 @@
 #define POISE_NATIVE_FUNCTION_HPP
 
 #include "../Poise.hpp"
+#include "Result.hpp"
 #include "Value.hpp"
 
 #include <type_traits>
@@ -15,12 +16,12 @@ namespace poise::runtime {
 class NativeFunction
 {
 public:
-    using Func = Value(*)(std::span<Value>);
+    using Func = Result<Value>(*)(std::span<Value>);
 
     NativeFunction(u8 arity, Func function);
 
     [[nodiscard]] auto arity() const noexcept -> u8;
-    [[nodiscard]] auto operator()(std::span<Value> args) const -> Value;
+    [[nodiscard]] auto operator()(std::span<Value> args) const -> Result<Value>;
 
 private:
     u8 m_arity;
@@ -1,5 +1,123 @@
 #include "Op.hpp"
 
+#include <array>
+
+namespace poise::runtime {
+auto operandWidths(Op op) noexcept -> std::span<const u8>
+{
+    static constexpr std::array<u8, 0> none{};
+    static constexpr std::array<u8, 1> byte{1};
+    static constexpr std::array<u8, 1> index{4};
+    static constexpr std::array<u8, 1> pointer{sizeof(usize)};
+    static constexpr std::array<u8, 2> twoIndexes{4, 4};
+    static constexpr std::array<u8, 2> conditionalJump{4, 1};
+    static constexpr std::array<u8, 3> member{sizeof(usize), 1, 4};
+    static constexpr std::array<u8, 3> call{1, 1, 1};
+    static constexpr std::array<u8, 3> declareLocals{1, 4, 4};
+    static constexpr std::array<u8, 3> forRangeInit{4, 1, 4};
+    static constexpr std::array<u8, 3> print{4, 1, 1};
+    static constexpr std::array<u8, 3> threeAddress{4, 4, 4};
+    static constexpr std::array<u8, 4> constructBuiltin{1, 1, 1, 1};
+    static constexpr std::array<u8, 4> callDirect{1, 1, 1, sizeof(usize)};
+
+    switch (op) {
+        case Op::AssignLocal:
+        case Op::AssignUpvalue:
+        case Op::CaptureLocal:
+        case Op::CaptureUpvalue:
+        case Op::EnterTry:
+        case Op::LoadUpvalue:
+        case Op::LoadConstant:
+        case Op::LoadLocal:
+        case Op::PopLocals:
+        case Op::Assert:
+        case Op::MakeLambda:
+        case Op::Jump:
+        case Op::CallNative:
+            return index;
+        case Op::LoadDirect:
+            return pointer;
+        case Op::ConstructBuiltin:
+            return constructBuiltin;
+        case Op::DeclareLocalsWithUnpack:
+            return declareLocals;
+        case Op::LoadMember:
+            return member;
+        case Op::LoadType:
+            return byte;
+        case Op::Print:
+            return print;
+        case Op::Call:
+        case Op::TailCall:
+            return call;
+        case Op::CallDirect:
+        case Op::TailCallDirect:
+            return callDirect;
+        case Op::ForRangeInit:
+            return forRangeInit;
+        case Op::ForRangeStep:
+        case Op::IncrementIterator:
+        case Op::InitIterator:
+        case Op::LoadLocalLoadConstant:
+        case Op::LoadLocalLoadLocal:
+            return twoIndexes;
+        case Op::JumpIfFalse:
+        case Op::JumpIfTrue:
+        case Op::LessThanJumpIfFalse:
+            return conditionalJump;
+        case Op::AddRegisters:
+        case Op::SubtractRegisters:
+        case Op::MultiplyRegisters:
+        case Op::DivideRegisters:
+        case Op::ModulusRegisters:
+        case Op::EqualRegisters:
+        case Op::NotEqualRegisters:
+        case Op::LessThanRegisters:
+        case Op::LessEqualRegisters:
+        case Op::GreaterThanRegisters:
+        case Op::GreaterEqualRegisters:
+            return threeAddress;
+        default:
+            return none;
+    }
+}
+
+auto threeAddressOp(Op op) noexcept -> std::optional<Op>
+{
+    switch (op) {
+        case Op::Addition:
+            return Op::AddRegisters;
+        case Op::Subtraction:
+            return Op::SubtractRegisters;
+        case Op::Multiply:
+            return Op::MultiplyRegisters;
+        case Op::Divide:
+            return Op::DivideRegisters;
+        case Op::Modulus:
+            return Op::ModulusRegisters;
+        case Op::Equal:
+            return Op::EqualRegisters;
+        case Op::NotEqual:
+            return Op::NotEqualRegisters;
+        case Op::LessThan:
+            return Op::LessThanRegisters;
+        case Op::LessEqual:
+            return Op::LessEqualRegisters;
+        case Op::GreaterThan:
+            return Op::GreaterThanRegisters;
+        case Op::GreaterEqual:
+            return Op::GreaterEqualRegisters;
+        default:
+            return std::nullopt;
+    }
+}
+
+auto isThreeAddressOp(Op op) noexcept -> bool
+{
+    return op >= Op::AddRegisters && op <= Op::GreaterEqualRegisters;
+}
+}   // namespace poise::runtime
+
 using namespace poise::runtime;
 
 auto fmt::formatter<Op>::format(Op op, format_context& context) const -> decltype(context.out())
@@ -7,24 +125,26 @@ auto fmt::formatter<Op>::format(Op op, format_context& context) const -> decltyp
     switch (op) {
         case Op::AssignLocal:
             return formatter<string_view>::format("AssignLocal", context);
+        case Op::AssignUpvalue:
+            return formatter<string_view>::format("AssignUpvalue", context);
         case Op::CaptureLocal:
             return formatter<string_view>::format("CaptureLocal", context);
+        case Op::CaptureUpvalue:
+            return formatter<string_view>::format("CaptureUpvalue", context);
         case Op::ConstructBuiltin:
             return formatter<string_view>::format("ConstructBuiltin", context);
-        case Op::DeclareLocal:
-            return formatter<string_view>::format("DeclareLocal", context);
         case Op::DeclareLocalsWithUnpack:
             return formatter<string_view>::format("DeclareLocalsWithUnpack", context);
         case Op::EnterTry:
             return formatter<string_view>::format("EnterTry", context);
         case Op::ExitTry:
             return formatter<string_view>::format("ExitTry", context);
-        case Op::LoadCapture:
-            return formatter<string_view>::format("LoadCapture", context);
+        case Op::LoadUpvalue:
+            return formatter<string_view>::format("LoadUpvalue", context);
         case Op::LoadConstant:
             return formatter<string_view>::format("LoadConstant", context);
-        case Op::LoadFunctionOrStruct:
-            return formatter<string_view>::format("LoadFunction", context);
+        case Op::LoadDirect:
+            return formatter<string_view>::format("LoadDirect", context);
         case Op::LoadLocal:
             return formatter<string_view>::format("LoadLocal", context);
         case Op::LoadMember:
@@ -97,10 +217,72 @@ auto fmt::formatter<Op>::format(Op op, format_context& context) const -> decltyp
             return formatter<string_view>::format("AssignIndex", context);
         case Op::LoadIndex:
             return formatter<string_view>::format("LoadIndex", context);
+        case Op::LoadLocalLoadConstant:
+            return formatter<string_view>::format("LoadLocalLoadConstant", context);
+        case Op::LoadLocalLoadLocal:
+            return formatter<string_view>::format("LoadLocalLoadLocal", context);
+        case Op::LessThanJumpIfFalse:
+            return formatter<string_view>::format("LessThanJumpIfFalse", context);
+        case Op::AddRegisters:
+            return formatter<string_view>::format("AddRegisters", context);
+        case Op::SubtractRegisters:
+            return formatter<string_view>::format("SubtractRegisters", context);
+        case Op::MultiplyRegisters:
+            return formatter<string_view>::format("MultiplyRegisters", context);
+        case Op::DivideRegisters:
+            return formatter<string_view>::format("DivideRegisters", context);
+        case Op::ModulusRegisters:
+            return formatter<string_view>::format("ModulusRegisters", context);
+        case Op::EqualRegisters:
+            return formatter<string_view>::format("EqualRegisters", context);
+        case Op::NotEqualRegisters:
+            return formatter<string_view>::format("NotEqualRegisters", context);
+        case Op::LessThanRegisters:
+            return formatter<string_view>::format("LessThanRegisters", context);
+        case Op::LessEqualRegisters:
+            return formatter<string_view>::format("LessEqualRegisters", context);
+        case Op::GreaterThanRegisters:
+            return formatter<string_view>::format("GreaterThanRegisters", context);
+        case Op::GreaterEqualRegisters:
+            return formatter<string_view>::format("GreaterEqualRegisters", context);
+        case Op::AddIntInt:
+            return formatter<string_view>::format("AddIntInt", context);
+        case Op::AddFloatFloat:
+            return formatter<string_view>::format("AddFloatFloat", context);
+        case Op::SubtractIntInt:
+            return formatter<string_view>::format("SubtractIntInt", context);
+        case Op::SubtractFloatFloat:
+            return formatter<string_view>::format("SubtractFloatFloat", context);
+        case Op::MultiplyIntInt:
+            return formatter<string_view>::format("MultiplyIntInt", context);
+        case Op::MultiplyFloatFloat:
+            return formatter<string_view>::format("MultiplyFloatFloat", context);
+        case Op::LessThanIntInt:
+            return formatter<string_view>::format("LessThanIntInt", context);
+        case Op::LessThanFloatFloat:
+            return formatter<string_view>::format("LessThanFloatFloat", context);
+        case Op::LessEqualIntInt:
+            return formatter<string_view>::format("LessEqualIntInt", context);
+        case Op::LessEqualFloatFloat:
+            return formatter<string_view>::format("LessEqualFloatFloat", context);
+        case Op::GreaterThanIntInt:
+            return formatter<string_view>::format("GreaterThanIntInt", context);
+        case Op::GreaterThanFloatFloat:
+            return formatter<string_view>::format("GreaterThanFloatFloat", context);
+        case Op::GreaterEqualIntInt:
+            return formatter<string_view>::format("GreaterEqualIntInt", context);
+        case Op::GreaterEqualFloatFloat:
+            return formatter<string_view>::format("GreaterEqualFloatFloat", context);
         case Op::Call:
             return formatter<string_view>::format("Call", context);
+        case Op::CallDirect:
+            return formatter<string_view>::format("CallDirect", context);
         case Op::CallNative:
             return formatter<string_view>::format("CallNative", context);
+        case Op::TailCall:
+            return formatter<string_view>::format("TailCall", context);
+        case Op::TailCallDirect:
+            return formatter<string_view>::format("TailCallDirect", context);
         case Op::IncrementIterator:
             return formatter<string_view>::format("IncrementIterator", context);
         case Op::InitIterator:
@@ -113,6 +295,10 @@ auto fmt::formatter<Op>::format(Op op, format_context& context) const -> decltyp
             return formatter<string_view>::format("JumpIfTrue", context);
         case Op::Exit:
             return formatter<string_view>::format("Exit", context);
+        case Op::ForRangeInit:
+            return formatter<string_view>::format("ForRangeInit", context);
+        case Op::ForRangeStep:
+            return formatter<string_view>::format("ForRangeStep", context);
         case Op::Return:
             return formatter<string_view>::format("Return", context);
         default:
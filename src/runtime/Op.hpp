@@ -5,20 +5,24 @@
 
 #include <fmt/format.h>
 
+#include <optional>
+#include <span>
+
 namespace poise::runtime {
 enum class Op : u8
 {
     // stack/state modification
     AssignLocal,
-    CaptureLocal,
+    AssignUpvalue,
+    CaptureLocal,   // captures a local of the current function for the lambda on top of the stack
+    CaptureUpvalue, // captures a variable the current function has itself captured
     ConstructBuiltin,
-    DeclareLocal,
     DeclareLocalsWithUnpack,
-    EnterTry,
+    EnterTry,   // only for try expressions, try blocks are in the chunk's exception handlers
     ExitTry,    // gracefully!
-    LoadCapture,
+    LoadUpvalue,
     LoadConstant,
-    LoadFunctionOrStruct,
+    LoadDirect, // a function or struct named at compile time, its operand is filled in by the link pass and doesn't own it
     LoadLocal,
     LoadMember,
     LoadType,
@@ -62,10 +66,49 @@ enum class Op : u8
     AssignIndex,
     LoadIndex,
 
+    // superinstructions, fused by Chunk::emitOp from the most frequently executed op pairs
+    LoadLocalLoadConstant,
+    LoadLocalLoadLocal,
+    LessThanJumpIfFalse,
+
+    // three-address ops, emitted in register mode in place of a binary op and the loads of its operands
+    AddRegisters,
+    SubtractRegisters,
+    MultiplyRegisters,
+    DivideRegisters,
+    ModulusRegisters,
+    EqualRegisters,
+    NotEqualRegisters,
+    LessThanRegisters,
+    LessEqualRegisters,
+    GreaterThanRegisters,
+    GreaterEqualRegisters,
+
+    // quickened ops, rewritten in place by the vm from the generic op when it sees these operand types
+    AddIntInt,
+    AddFloatFloat,
+    SubtractIntInt,
+    SubtractFloatFloat,
+    MultiplyIntInt,
+    MultiplyFloatFloat,
+    LessThanIntInt,
+    LessThanFloatFloat,
+    LessEqualIntInt,
+    LessEqualFloatFloat,
+    GreaterThanIntInt,
+    GreaterThanFloatFloat,
+    GreaterEqualIntInt,
+    GreaterEqualFloatFloat,
+
     // jumping/control flow
     Call,
-    CallNative,
+    CallDirect, // a call to a function named at compile time, its operands are filled in by the link pass
+    CallNative, // its operand is the index of the native function, the args are read in place on the stack
+    TailCall,   // Call and CallDirect in tail position, reusing the current frame instead of pushing a new one
+    TailCallDirect,
     Exit,
+    ForRangeInit,   // a for loop over a range literal, its counter, remaining steps and increment are in the frame
+    ForRangeStep,
     IncrementIterator,
     InitIterator,
     Jump,
@@ -74,11 +117,17 @@ enum class Op : u8
     Return,
 };
 
-struct OpLine
-{
-    Op op;
-    usize line;
-};
+// the byte widths of the immediate operands that follow an op in the code stream, in the order they are emitted
+[[nodiscard]] auto operandWidths(Op op) noexcept -> std::span<const u8>;
+
+// the operands of the three-address ops are a left hand side, a right hand side, and a destination,
+// each is a local slot, a constant if the high bit is set, or the top of the stack
+inline constexpr u32 RegisterConstantBit = 0x8000'0000_u32;
+inline constexpr u32 RegisterStack = 0xFFFF'FFFF_u32;
+
+// the three-address version of a binary op, if it has one
+[[nodiscard]] auto threeAddressOp(Op op) noexcept -> std::optional<Op>;
+[[nodiscard]] auto isThreeAddressOp(Op op) noexcept -> bool;
 }   // namespace poise::runtime
 
 template<>
@@ -0,0 +1,46 @@
+#ifndef POISE_RESULT_HPP
+#define POISE_RESULT_HPP
+
+#include "../Poise.hpp"
+#include "../objects/Exception.hpp"
+
+#include <expected>
+#include <string>
+
+namespace poise::runtime {
+// a runtime error that has not been raised yet, the vm turns it into an Exception object
+// and jumps straight to the innermost try block instead of unwinding the C++ stack
+struct Error
+{
+    objects::Exception::ExceptionType exceptionType;
+    std::string message;
+};
+
+template<typename T>
+using Result = std::expected<T, Error>;
+
+[[nodiscard]] inline auto error(objects::Exception::ExceptionType exceptionType, std::string message) -> std::unexpected<Error>
+{
+    return std::unexpected<Error>{Error{exceptionType, std::move(message)}};
+}
+
+[[nodiscard]] inline auto error(objects::Exception::ExceptionType exceptionType) -> std::unexpected<Error>
+{
+    return error(exceptionType, fmt::format("{}", exceptionType));
+}
+
+// for code outside the vm loop that still reports errors by throwing
+template<typename T>
+[[nodiscard]] inline auto unwrap(Result<T> result) -> T
+{
+    if (!result) {
+        throw objects::Exception{result.error().exceptionType, std::move(result.error().message)};
+    }
+
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+}   // namespace poise::runtime
+
+#endif  // #ifndef POISE_RESULT_HPP
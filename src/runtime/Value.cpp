@@ -2,6 +2,8 @@
 #include "../objects/Exception.hpp"
 #include "../objects/iterables/hashables/Set.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <charconv>
 #include <functional>
 #include <version>
@@ -9,133 +11,80 @@
 namespace poise::runtime {
 using objects::Exception;
 
-Value::Value()
-    : m_type{TypeInternal::None}
-{
-    m_data.none = std::nullptr_t{};
-}
-
-Value::Value(const Value& other)
-    : m_type{other.typeInternal()}
-{
-    if (typeInternal() == TypeInternal::String) {
+namespace {
 #ifdef POISE_INTERN_STRINGS
-        m_data.string = other.m_data.string;
-#else
-        m_data.string = new std::string{other.string()};
-#endif
-    } else if (typeInternal() == TypeInternal::Object) {
-        m_data.object = other.object();
-        object()->incrementRefCount();
-    } else {
-        m_data = other.m_data;
-    }
-}
+// strings made at runtime are only interned if they look like names, like member names and Dict keys,
+// anything else is usually the result of concatenating or converting something and won't be seen again
+constexpr auto s_maxInternedRuntimeString = 32_uz;
 
-Value::Value(Value&& other) noexcept
-    : m_data{other.data()}
-    , m_type{other.typeInternal()}
+auto isIdentifierLike(std::string_view string) noexcept -> bool
 {
-    if (typeInternal() == TypeInternal::String || typeInternal() == TypeInternal::Object) {
-        other.makeNone();
-    }
-}
-
-Value& Value::operator=(const Value& other)
-{
-    if (this != &other) {
-#ifndef POISE_INTERN_STRINGS
-        if (typeInternal() == TypeInternal::String) {
-            delete m_data.string;
-        } else
-#endif
-
-        if (typeInternal() == TypeInternal::Object) {
-            if (object()->decrementRefCount() == 0_uz) {
-                memory::Gc::instance().stopTrackingObject(object());
-                delete object();
-            }
-        }
-
-        m_type = other.typeInternal();
-
-        if (typeInternal() == TypeInternal::String) {
-#ifdef POISE_INTERN_STRINGS
-            m_data.string = other.m_data.string;
-#else
-            m_data.string = new std::string{other.string()};
-#endif
-        } else if (typeInternal() == TypeInternal::Object) {
-            m_data.object = other.object();
-            object()->incrementRefCount();
-        } else {
-            m_data = other.data();
-        }
-    }
+    const auto isIdentifierChar = [] (char c) -> bool {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
 
-    return *this;
+    return !string.empty()
+        && string.size() <= s_maxInternedRuntimeString
+        && !std::isdigit(static_cast<unsigned char>(string.front()))
+        && std::ranges::all_of(string, isIdentifierChar);
 }
-
-Value& Value::operator=(Value&& other) noexcept
-{
-    if (this != &other) {
-#ifndef POISE_INTERN_STRINGS
-        if (typeInternal() == TypeInternal::String) {
-            delete m_data.string;
-        } else
 #endif
 
-        if (typeInternal() == TypeInternal::Object) {
-            if (object()->decrementRefCount() == 0_uz) {
-                memory::Gc::instance().stopTrackingObject(object());
-                delete object();
-            }
-        }
-
-        m_type = other.typeInternal();
-        m_data = other.data();
+// a copy of a string shares it, and there's only one interned string with the same characters,
+// otherwise only compare the characters if the hashes match
+auto sharedStringsEqual(const memory::SharedString* string, const memory::SharedString* other) noexcept -> bool
+{
+    if (string == other) {
+        return true;
+    }
 
-        if (typeInternal() == TypeInternal::String || typeInternal() == TypeInternal::Object) {
-            other.makeNone();
-        }
+    if (string->interned() && other->interned()) {
+        return false;
     }
 
-    return *this;
+    return string->hash() == other->hash() && string->view() == other->view();
 }
 
-Value::~Value()
+auto createSharedString(std::string_view string, [[maybe_unused]] bool isConstant) -> memory::SharedString*
 {
-#ifndef POISE_INTERN_STRINGS
-    if (typeInternal() == TypeInternal::String) {
-        delete m_data.string;
-    } else
+#ifdef POISE_INTERN_STRINGS
+    if (isConstant || isIdentifierLike(string)) {
+        return memory::internSharedString(string);
+    }
 #endif
 
-    if (typeInternal() == TypeInternal::Object) {
-        if (object()->decrementRefCount() == 0_uz) {
-            memory::Gc::instance().stopTrackingObject(object());
-            delete object();
-        }
-    }
+    return memory::SharedString::create(string);
 }
+}   // namespace
 
 auto Value::none() -> Value
 {
     return std::nullptr_t{};
 }
 
-auto Value::string() const noexcept -> const std::string&
+auto Value::internedString(std::string_view string) -> Value
 {
-#ifdef POISE_INTERN_STRINGS
-    return memory::findInternedString(m_data.string);
+    Value value;
+    value.storeString(string, true);
+    return value;
+}
+
+auto Value::string() const noexcept -> std::string_view
+{
+#ifdef POISE_NAN_BOXING
+    return sharedString()->view();
 #else
-    return *m_data.string;
+    if (const auto shared = sharedString()) {
+        return shared->view();
+    }
+
+    return {m_data.smallString, m_smallStringSize};
 #endif
 }
 
 auto Value::object() const noexcept -> objects::Object*
 {
-    return typeInternal() == TypeInternal::Object ? m_data.object : nullptr;
+    return typeInternal() == TypeInternal::Object ? rawObject() : nullptr;
 }
 
 auto Value::type() const noexcept -> types::Type
@@ -158,8 +107,20 @@ auto Value::hash() const noexcept -> usize
             return std::hash<i64>{}(value<i64>());
         case TypeInternal::None:
             return std::hash<std::nullptr_t>{}(value<std::nullptr_t>());
-        case TypeInternal::String:
-            return std::hash<std::string>{}(string());
+        case TypeInternal::String: {
+#ifdef POISE_NAN_BOXING
+            return sharedString()->hash();
+#else
+            if (const auto shared = sharedString()) {
+                return shared->hash();
+            }
+
+            // the unused bytes of a small string are zeroed, so its characters can be hashed as one word
+            auto word = smallStringWord() ^ static_cast<u64>(m_smallStringSize);
+            word *= 0x9E37'79B9'7F4A'7C15_u64;
+            return static_cast<usize>(word ^ (word >> 32_u64));
+#endif
+        }
         case TypeInternal::Object:
             return std::hash<objects::Object*>{}(object());
         default:
@@ -167,11 +128,6 @@ auto Value::hash() const noexcept -> usize
     }
 }
 
-auto Value::typeInternal() const noexcept -> TypeInternal
-{
-    return m_type;
-}
-
 auto Value::print(FILE* stream) const -> void
 {
     fmt::print(stream, "{}", toString());
@@ -197,7 +153,7 @@ auto Value::toBool() const noexcept -> bool
     }
 }
 
-auto Value::toFloat() const -> f64
+auto Value::tryToFloat() const -> Result<f64>
 {
     switch (typeInternal()) {
         case TypeInternal::Bool:
@@ -209,33 +165,33 @@ auto Value::toFloat() const -> f64
         case TypeInternal::String: {
 #ifdef _LIBCPP_VERSION
             try {
-                return std::stod(string());
+                return std::stod(std::string{string()});
             } catch (const std::invalid_argument&) {
-                throw Exception(Exception::ExceptionType::InvalidCast, fmt::format("Cannot convert '{}' to Float", string()));
+                return error(Exception::ExceptionType::InvalidCast, fmt::format("Cannot convert '{}' to Float", string()));
             } catch (const std::out_of_range&) {
-                throw Exception(Exception::ExceptionType::InvalidCast, fmt::format("{} out of range for Float", string()));
+                return error(Exception::ExceptionType::InvalidCast, fmt::format("{} out of range for Float", string()));
             }
 #else
             auto res{0.0};
             const auto [ptr, ec] = std::from_chars(string().data(), string().data() + string().length(), res);
 
             if (ec == std::errc::invalid_argument) {
-                throw Exception(Exception::ExceptionType::InvalidCast, fmt::format("Cannot convert '{}' to Float", string()));
+                return error(Exception::ExceptionType::InvalidCast, fmt::format("Cannot convert '{}' to Float", string()));
             }
 
             if (ec == std::errc::result_out_of_range) {
-                throw Exception(Exception::ExceptionType::InvalidCast, fmt::format("{} out of range for Float", string()));
+                return error(Exception::ExceptionType::InvalidCast, fmt::format("{} out of range for Float", string()));
             }
 
             return res;
 #endif
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidType, fmt::format("Cannot convert {} to Float", type()));
+            return error(Exception::ExceptionType::InvalidType, fmt::format("Cannot convert {} to Float", type()));
     }
 }
 
-auto Value::toInt() const -> i64
+auto Value::tryToInt() const -> Result<i64>
 {
     switch (typeInternal()) {
         case TypeInternal::Bool:
@@ -249,17 +205,17 @@ auto Value::toInt() const -> i64
             const auto [ptr, ec] = std::from_chars(string().data(), string().data() + string().length(), res);
 
             if (ec == std::errc::invalid_argument) {
-                throw Exception(Exception::ExceptionType::InvalidCast, fmt::format("Cannot convert '{}' to Int", string()));
+                return error(Exception::ExceptionType::InvalidCast, fmt::format("Cannot convert '{}' to Int", string()));
             }
 
             if (ec == std::errc::result_out_of_range) {
-                throw Exception(Exception::ExceptionType::InvalidCast, fmt::format("{} out of range for Int", string()));
+                return error(Exception::ExceptionType::InvalidCast, fmt::format("{} out of range for Int", string()));
             }
 
             return res;
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidType, fmt::format("Cannot convert {} to Int", type()));
+            return error(Exception::ExceptionType::InvalidType, fmt::format("Cannot convert {} to Int", type()));
     }
 }
 
@@ -277,13 +233,13 @@ auto Value::toString() const noexcept -> std::string
         case TypeInternal::Object:
             return object()->toString();
         case TypeInternal::String:
-            return string();
+            return std::string{string()};
         default:
             POISE_UNREACHABLE();
     }
 }
 
-auto Value::operator|(const Value& other) const -> Value
+auto Value::bitwiseOr(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int: {
@@ -291,7 +247,7 @@ auto Value::operator|(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() | other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for |: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for |: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Object: {
@@ -302,11 +258,11 @@ auto Value::operator|(const Value& other) const -> Value
             [[fallthrough]];
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for |: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for |: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator^(const Value& other) const -> Value
+auto Value::bitwiseXor(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int: {
@@ -314,7 +270,7 @@ auto Value::operator^(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() ^ other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for ^: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for ^: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Object: {
@@ -325,11 +281,11 @@ auto Value::operator^(const Value& other) const -> Value
             [[fallthrough]];
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for ^: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for ^: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator&(const Value& other) const -> Value
+auto Value::bitwiseAnd(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int: {
@@ -337,7 +293,7 @@ auto Value::operator&(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() & other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for &: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for &: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Object: {
@@ -348,11 +304,11 @@ auto Value::operator&(const Value& other) const -> Value
             [[fallthrough]];
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for &: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for &: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator<<(const Value& other) const -> Value
+auto Value::leftShift(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int: {
@@ -360,15 +316,15 @@ auto Value::operator<<(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() << other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for <<: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for <<: '{}' and '{}'", type(), other.type()));
             }
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for <<: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for <<: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator>>(const Value& other) const -> Value
+auto Value::rightShift(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int: {
@@ -376,15 +332,15 @@ auto Value::operator>>(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() >> other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for >>: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for >>: '{}' and '{}'", type(), other.type()));
             }
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for >>: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for >>: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator+(const Value& other) const -> Value
+auto Value::add(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Float: {
@@ -394,7 +350,7 @@ auto Value::operator+(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<f64>() + static_cast<f64>(other.value<i64>());
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for +: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for +: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Int: {
@@ -404,17 +360,17 @@ auto Value::operator+(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() + other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for +: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for +: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::String:
-            return string() + other.toString();
+            return concatenate(other);
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for +: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for +: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator-(const Value& other) const -> Value
+auto Value::subtract(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Float: {
@@ -424,7 +380,7 @@ auto Value::operator-(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<f64>() - static_cast<f64>(other.value<i64>());
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for -: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for -: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Int: {
@@ -434,7 +390,7 @@ auto Value::operator-(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() - other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for -: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for -: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Object: {
@@ -445,55 +401,55 @@ auto Value::operator-(const Value& other) const -> Value
             [[fallthrough]];
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for -: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for -: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator/(const Value& other) const -> Value
+auto Value::divide(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Float: {
             switch (other.typeInternal()) {
                 case TypeInternal::Float: {
                     if (other.value<f64>() == 0.0) {
-                        throw Exception(Exception::ExceptionType::DivisionByZero);
+                        return error(Exception::ExceptionType::DivisionByZero);
                     }
                     return value<f64>() / other.value<f64>();
                 }
                 case TypeInternal::Int: {
                     if (other.value<i64>() == 0_i64) {
-                        throw Exception(Exception::ExceptionType::DivisionByZero);
+                        return error(Exception::ExceptionType::DivisionByZero);
                     }
                     return value<f64>() / static_cast<f64>(other.value<i64>());
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for /: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for /: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Int: {
             switch (other.typeInternal()) {
                 case TypeInternal::Float: {
                     if (other.value<f64>() == 0.0) {
-                        throw Exception(Exception::ExceptionType::DivisionByZero);
+                        return error(Exception::ExceptionType::DivisionByZero);
                     }
                     return static_cast<f64>(value<i64>()) / other.value<f64>();
                 }
                 case TypeInternal::Int: {
                     if (other.value<i64>() == 0_i64) {
-                        throw Exception(Exception::ExceptionType::DivisionByZero);
+                        return error(Exception::ExceptionType::DivisionByZero);
                     }
                     return value<i64>() / other.value<i64>();
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for /: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for /: '{}' and '{}'", type(), other.type()));
             }
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for /: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for /: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator*(const Value& other) const -> Value
+auto Value::multiply(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Float: {
@@ -503,7 +459,7 @@ auto Value::operator*(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<f64>() * static_cast<f64>(other.value<i64>());
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Int: {
@@ -513,14 +469,14 @@ auto Value::operator*(const Value& other) const -> Value
                 case TypeInternal::Int:
                     return value<i64>() * other.value<i64>();
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::String: {
             switch (other.typeInternal()) {
                 case TypeInternal::Int: {
                     if (other.value<i64>() < 0) {
-                        throw Exception(Exception::ExceptionType::InvalidOperand, "Factor to repeat string cannot be type");
+                        return error(Exception::ExceptionType::InvalidOperand, "Factor to repeat string cannot be type");
                     }
 
                     std::string res;
@@ -532,15 +488,15 @@ auto Value::operator*(const Value& other) const -> Value
                     return res;
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
             }
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for *: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator%(const Value& other) const -> Value
+auto Value::modulus(const Value& other) const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int: {
@@ -549,11 +505,11 @@ auto Value::operator%(const Value& other) const -> Value
                     return value<i64>() % other.value<i64>();
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for %: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for %: '{}' and '{}'", type(), other.type()));
             }
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for %: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand types for %: '{}' and '{}'", type(), other.type()));
     }
 }
 
@@ -562,17 +518,17 @@ auto Value::operator!() const noexcept -> Value
     return !toBool();
 }
 
-auto Value::operator~() const -> Value
+auto Value::bitwiseNot() const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int:
             return ~value<i64>();
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for ~: '{}'", type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for ~: '{}'", type()));
     }
 }
 
-auto Value::operator-() const -> Value
+auto Value::negate() const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int:
@@ -580,11 +536,11 @@ auto Value::operator-() const -> Value
         case TypeInternal::Float:
             return -value<f64>();
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for -: '{}'", type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for -: '{}'", type()));
     }
 }
 
-auto Value::operator+() const -> Value
+auto Value::unaryPlus() const -> Result<Value>
 {
     switch (typeInternal()) {
         case TypeInternal::Int:
@@ -592,7 +548,7 @@ auto Value::operator+() const -> Value
         case TypeInternal::Float:
             return +value<f64>();
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for +: '{}'", type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for +: '{}'", type()));
     }
 }
 
@@ -645,10 +601,25 @@ auto Value::operator==(const Value& other) const noexcept -> bool
             return other.typeInternal() == TypeInternal::None;
         }
         case TypeInternal::String: {
-#ifdef POISE_INTERN_STRINGS
-            return other.typeInternal() == TypeInternal::String && data().string == other.data().string;
+            if (other.typeInternal() != TypeInternal::String) {
+                return false;
+            }
+
+#ifdef POISE_NAN_BOXING
+            return sharedStringsEqual(sharedString(), other.sharedString());
 #else
-            return other.typeInternal() == TypeInternal::String && string() == other.string();
+            const auto shared = sharedString();
+            const auto otherShared = other.sharedString();
+            if (shared != nullptr && otherShared != nullptr) {
+                return sharedStringsEqual(shared, otherShared);
+            }
+
+            // strings that fit in a value are always stored in it, so a small string never equals a shared one
+            if (shared != nullptr || otherShared != nullptr) {
+                return false;
+            }
+
+            return m_smallStringSize == other.m_smallStringSize && smallStringWord() == other.smallStringWord();
 #endif
         }
         default:
@@ -661,7 +632,7 @@ auto Value::operator!=(const Value& other) const noexcept -> bool
     return !(*this == other);
 }
 
-auto Value::operator<(const Value& other) const -> bool
+auto Value::lessThan(const Value& other) const -> Result<bool>
 {
     switch (typeInternal()) {
         case TypeInternal::Float: {
@@ -673,7 +644,7 @@ auto Value::operator<(const Value& other) const -> bool
                     return value<f64>() < static_cast<f64>(other.value<i64>());
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Int: {
@@ -685,15 +656,15 @@ auto Value::operator<(const Value& other) const -> bool
                     return value<i64>() < other.value<i64>();
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <: '{}' and '{}'", type(), other.type()));
             }
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator<=(const Value& other) const -> bool
+auto Value::lessEqual(const Value& other) const -> Result<bool>
 {
     switch (typeInternal()) {
         case TypeInternal::Float: {
@@ -705,7 +676,7 @@ auto Value::operator<=(const Value& other) const -> bool
                     return value<f64>() <= static_cast<f64>(other.value<i64>());
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <=: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <=: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Int: {
@@ -717,7 +688,7 @@ auto Value::operator<=(const Value& other) const -> bool
                     return value<i64>() <= other.value<i64>();
                 }
                 default:
-                    throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <=: '{}' and '{}'", type(), other.type()));
+                    return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <=: '{}' and '{}'", type(), other.type()));
             }
         }
         case TypeInternal::Object: {
@@ -728,22 +699,24 @@ auto Value::operator<=(const Value& other) const -> bool
             [[fallthrough]];
         }
         default:
-            throw Exception(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <=: '{}' and '{}'", type(), other.type()));
+            return error(Exception::ExceptionType::InvalidOperand, fmt::format("Invalid operand type for <=: '{}' and '{}'", type(), other.type()));
     }
 }
 
-auto Value::operator>(const Value& other) const -> bool
+auto Value::greaterThan(const Value& other) const -> Result<bool>
 {
-    return !(*this <= other);
+    const auto result = lessEqual(other);
+    return result ? Result<bool>{!*result} : result;
 }
 
-auto Value::operator>=(const Value& other) const -> bool
+auto Value::greaterEqual(const Value& other) const -> Result<bool>
 {
     if (type() == types::Type::Set && other.type() == types::Type::Set) {
         return object()->asSet()->isSuperset(*other.object()->asSet());
     }
 
-    return !(*this < other);
+    const auto result = lessThan(other);
+    return result ? Result<bool>{!*result} : result;
 }
 
 auto Value::operator||(const Value& other) const noexcept -> bool
@@ -756,15 +729,223 @@ auto Value::operator&&(const Value& other) const noexcept -> bool
     return toBool() && other.toBool();
 }
 
-auto Value::data() const noexcept -> decltype(m_data)
+auto Value::toFloat() const -> f64
+{
+    return unwrap(tryToFloat());
+}
+
+auto Value::toInt() const -> i64
+{
+    return unwrap(tryToInt());
+}
+
+auto Value::operator|(const Value& other) const -> Value
+{
+    return unwrap(bitwiseOr(other));
+}
+
+auto Value::operator^(const Value& other) const -> Value
 {
-    return m_data;
+    return unwrap(bitwiseXor(other));
 }
 
-auto Value::makeNone() noexcept -> void
+auto Value::operator&(const Value& other) const -> Value
+{
+    return unwrap(bitwiseAnd(other));
+}
+
+auto Value::operator<<(const Value& other) const -> Value
+{
+    return unwrap(leftShift(other));
+}
+
+auto Value::operator>>(const Value& other) const -> Value
 {
-    m_data.none = std::nullptr_t{};
-    m_type = TypeInternal::None;
+    return unwrap(rightShift(other));
+}
+
+auto Value::operator+(const Value& other) const -> Value
+{
+    return unwrap(add(other));
+}
+
+auto Value::operator-(const Value& other) const -> Value
+{
+    return unwrap(subtract(other));
+}
+
+auto Value::operator/(const Value& other) const -> Value
+{
+    return unwrap(divide(other));
+}
+
+auto Value::operator*(const Value& other) const -> Value
+{
+    return unwrap(multiply(other));
+}
+
+auto Value::operator%(const Value& other) const -> Value
+{
+    return unwrap(modulus(other));
+}
+
+auto Value::operator~() const -> Value
+{
+    return unwrap(bitwiseNot());
+}
+
+auto Value::operator-() const -> Value
+{
+    return unwrap(negate());
+}
+
+auto Value::operator+() const -> Value
+{
+    return unwrap(unaryPlus());
+}
+
+auto Value::operator<(const Value& other) const -> bool
+{
+    return unwrap(lessThan(other));
+}
+
+auto Value::operator<=(const Value& other) const -> bool
+{
+    return unwrap(lessEqual(other));
+}
+
+auto Value::operator>(const Value& other) const -> bool
+{
+    return unwrap(greaterThan(other));
+}
+
+auto Value::operator>=(const Value& other) const -> bool
+{
+    return unwrap(greaterEqual(other));
+}
+
+auto Value::storeString(std::string_view string, bool isConstant) -> void
+{
+#ifdef POISE_NAN_BOXING
+    m_bits = boxed(static_cast<u64>(TypeInternal::String), reinterpret_cast<u64>(createSharedString(string, isConstant)));
+#else
+    m_type = TypeInternal::String;
+
+    if (string.size() <= s_maxSmallString) {
+        m_smallStringSize = static_cast<u8>(string.size());
+        std::ranges::fill(m_data.smallString, '\0');
+        std::ranges::copy(string, m_data.smallString);
+    } else {
+        m_smallStringSize = s_notSmallString;
+        m_data.sharedString = createSharedString(string, isConstant);
+    }
+#endif
+}
+
+auto Value::storeSharedString(memory::SharedString* string) noexcept -> void
+{
+#ifdef POISE_NAN_BOXING
+    m_bits = boxed(static_cast<u64>(TypeInternal::String), reinterpret_cast<u64>(string));
+#else
+    m_type = TypeInternal::String;
+    m_smallStringSize = s_notSmallString;
+    m_data.sharedString = string;
+#endif
+}
+
+auto Value::stringSize() const noexcept -> usize
+{
+#ifdef POISE_NAN_BOXING
+    return sharedString()->size();
+#else
+    if (const auto shared = sharedString()) {
+        return shared->size();
+    }
+
+    return m_smallStringSize;
+#endif
+}
+
+auto Value::retainSharedString() const -> memory::SharedString*
+{
+    if (const auto shared = sharedString()) {
+        shared->retain();
+        return shared;
+    }
+
+    return memory::SharedString::create(string());
+}
+
+auto Value::concatenate(const Value& other) const -> Value
+{
+    const auto rhs = other.typeInternal() == TypeInternal::String ? other : Value{other.toString()};
+
+    // short results are copied straight away, anything longer is only copied when it's read,
+    // so appending to a long string over and over doesn't copy it every time
+    if (stringSize() + rhs.stringSize() < s_minLazyConcatenation) {
+        return std::string{string()}.append(rhs.string());
+    }
+
+    Value res;
+    res.storeSharedString(memory::SharedString::concatenate(retainSharedString(), rhs.retainSharedString()));
+    return res;
+}
+
+auto Value::retainOwned() -> void
+{
+#ifdef POISE_NAN_BOXING
+    switch (tag()) {
+        case static_cast<u64>(TypeInternal::String):
+            sharedString()->retain();
+            break;
+        case static_cast<u64>(TypeInternal::Object):
+            rawObject()->incrementRefCount();
+            break;
+        case s_heapIntTag:
+            m_bits = boxed(tag(), reinterpret_cast<u64>(new i64{rawInt()}));
+            break;
+        default:
+            POISE_UNREACHABLE();
+    }
+#else
+    if (typeInternal() == TypeInternal::String) {
+        sharedString()->retain();
+    } else if (typeInternal() == TypeInternal::Object) {
+        object()->incrementRefCount();
+    }
+#endif
+}
+
+auto Value::releaseOwned() noexcept -> void
+{
+    auto releaseObject = [] (objects::Object* object) {
+        if (object->decrementRefCount() == 0_uz) {
+            memory::Gc::instance().stopTrackingObject(object);
+            delete object;
+        }
+    };
+
+#ifdef POISE_NAN_BOXING
+    switch (tag()) {
+        case static_cast<u64>(TypeInternal::String):
+            sharedString()->release();
+            break;
+        case static_cast<u64>(TypeInternal::Object):
+            releaseObject(rawObject());
+            break;
+        case s_heapIntTag:
+            delete reinterpret_cast<i64*>(payload());
+            break;
+        default:
+            POISE_UNREACHABLE();
+    }
+#else
+    if (typeInternal() == TypeInternal::String) {
+        sharedString()->release();
+    } else if (typeInternal() == TypeInternal::Object) {
+        releaseObject(object());
+    }
+#endif
 }
 }   // namespace poise::runtime
 
@@ -3,13 +3,18 @@
 
 #include "../Poise.hpp"
 #include "memory/Gc.hpp"
+#include "memory/SharedString.hpp"
 #include "memory/StringInterner.hpp"
 #include "../objects/Object.hpp"
+#include "Result.hpp"
 #include "Types.hpp"
 
 #include <fmt/format.h>
 
+#include <bit>
+#include <cmath>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace poise::runtime {
@@ -40,47 +45,67 @@ concept Object = std::is_base_of_v<objects::Object, T>;
 class Value
 {
 public:
-    Value();
-    Value(const Value& other);
-    Value(Value&& other) noexcept;
+    // these are defined here so copying, moving and destroying a value that doesn't own anything
+    // is just copying its representation, the ownership work is done out of line
+    Value() noexcept
+    {
+        makeNone();
+    }
+
+    Value(const Value& other)
+    {
+        copyRepresentation(other);
+        retain();
+    }
+
+    Value(Value&& other) noexcept
+    {
+        copyRepresentation(other);
+        if (ownsMemory()) {
+            other.makeNone();
+        }
+    }
 
     template<Primitive T>
     /* implicit */ Value(T value)
     {
-        if constexpr (IsString<T>) {
-            m_type = TypeInternal::String;
+        store(std::move(value));
+    }
 
-#ifdef POISE_INTERN_STRINGS
-            m_data.string = memory::internString(std::move(value));
-#else
-            m_data.string = new std::string{std::move(value)};
-#endif
-        } else if constexpr (IsNone<T>) {
-            m_type = TypeInternal::None;
-            m_data.none = value;
-        } else if constexpr (IsInteger<T>) {
-            m_type = TypeInternal::Int;
-            m_data.integer = static_cast<i64>(value);
-        } else if constexpr (IsFloatingPoint<T>) {
-            m_type = TypeInternal::Float;
-            m_data.floating = static_cast<f64>(value);
-        } else if constexpr (IsBool<T>) {
-            m_type = TypeInternal::Bool;
-            m_data.boolean = value;
+    Value& operator=(const Value& other)
+    {
+        if (this != &other) {
+            release();
+            copyRepresentation(other);
+            retain();
         }
+
+        return *this;
     }
 
-    Value& operator=(const Value& other);
-    Value& operator=(Value&& other) noexcept;
+    Value& operator=(Value&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            copyRepresentation(other);
+            if (ownsMemory()) {
+                other.makeNone();
+            }
+        }
+
+        return *this;
+    }
 
-    ~Value();
+    ~Value()
+    {
+        release();
+    }
 
     template<Object T, typename... Args>
     [[nodiscard]] static auto createObject(Args&& ... args) -> Value
     {
         Value value;
-        value.m_type = TypeInternal::Object;
-        value.m_data.object = new T(std::forward<Args>(args)...);
+        value.storeObject(new T(std::forward<Args>(args)...));
 
         memory::Gc::instance().trackObject(value.object());
         value.object()->incrementRefCount();
@@ -93,52 +118,29 @@ public:
     [[nodiscard]] static auto createObjectUntracked(Args&& ... args) -> Value
     {
         Value value;
-        value.m_type = TypeInternal::Object;
-        value.m_data.object = new T(std::forward<Args>(args)...);
+        value.storeObject(new T(std::forward<Args>(args)...));
+        value.object()->incrementRefCount();
+        return value;
+    }
+
+    // a new reference to an object that is already owned somewhere else
+    [[nodiscard]] static auto fromObject(objects::Object* object) -> Value
+    {
+        Value value;
+        value.storeObject(object);
         value.object()->incrementRefCount();
         return value;
     }
 
     [[nodiscard]] static auto none() -> Value;
+    // for strings known when compiling, which are always interned when POISE_INTERN_STRINGS is defined
+    [[nodiscard]] static auto internedString(std::string_view string) -> Value;
 
     template<Primitive T>
     Value& operator=(T value)
     {
-#ifndef POISE_INTERN_STRINGS
-        if (typeInternal() == TypeInternal::String) {
-            delete m_data.string;
-        } else
-#endif
-
-        if (typeInternal() == TypeInternal::Object) {
-            if (object()->decrementRefCount() == 0_uz) {
-                memory::Gc::instance().stopTrackingObject(object());
-                delete object();
-            }
-        }
-
-        if constexpr (IsString<T>) {
-            m_type = TypeInternal::String;
-
-#ifdef POISE_INTERN_STRINGS
-            m_data.string = memory::internString(std::move(value));
-#else
-            m_data.string = new std::string{std::move(value)};
-#endif
-        } else if constexpr (IsNone<T>) {
-            m_type = TypeInternal::None;
-            m_data.none = value;
-        } else if constexpr (IsInteger<T>) {
-            m_type = TypeInternal::Int;
-            m_data.integer = static_cast<i64>(value);
-        } else if constexpr (IsFloatingPoint<T>) {
-            m_type = TypeInternal::Float;
-            m_data.floating = static_cast<f64>(value);
-        } else if constexpr (IsBool<T>) {
-            m_type = TypeInternal::Bool;
-            m_data.boolean = value;
-        }
-
+        release();
+        store(std::move(value));
         return *this;
     }
 
@@ -146,17 +148,29 @@ public:
     [[nodiscard]] auto value() const -> T
     {
         if constexpr (std::is_same_v<T, std::nullptr_t>) {
-            return m_data.none;
+            return nullptr;
         } else if constexpr (IsInteger<T>) {
-            return static_cast<T>(m_data.integer);
+            return static_cast<T>(rawInt());
         } else if constexpr (IsFloatingPoint<T>) {
-            return static_cast<T>(m_data.floating);
+            return static_cast<T>(rawFloat());
         } else if constexpr (IsBool<T>) {
-            return m_data.boolean;
+            return rawBool();
         }
     }
 
-    [[nodiscard]] auto string() const noexcept -> const std::string&;
+    // cheap type checks for the quickened ops, these avoid going through type()
+    [[nodiscard]] auto isInt() const noexcept -> bool
+    {
+        return typeInternal() == TypeInternal::Int;
+    }
+
+    [[nodiscard]] auto isFloat() const noexcept -> bool
+    {
+        return typeInternal() == TypeInternal::Float;
+    }
+
+    // only valid while this value holds the string
+    [[nodiscard]] auto string() const noexcept -> std::string_view;
     [[nodiscard]] auto object() const noexcept -> objects::Object*;
     [[nodiscard]] auto type() const noexcept -> types::Type;
     [[nodiscard]] auto hash() const noexcept -> usize;
@@ -168,6 +182,31 @@ public:
     [[nodiscard]] auto toInt() const -> i64;
     [[nodiscard]] auto toString() const noexcept -> std::string;
 
+    // the checked operations report errors by value so the vm can handle them without unwinding,
+    // the operators below are wrappers around them that throw
+    [[nodiscard]] auto tryToFloat() const -> Result<f64>;
+    [[nodiscard]] auto tryToInt() const -> Result<i64>;
+
+    [[nodiscard]] auto bitwiseOr(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto bitwiseXor(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto bitwiseAnd(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto leftShift(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto rightShift(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto add(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto subtract(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto divide(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto multiply(const Value& other) const -> Result<Value>;
+    [[nodiscard]] auto modulus(const Value& other) const -> Result<Value>;
+
+    [[nodiscard]] auto bitwiseNot() const -> Result<Value>;
+    [[nodiscard]] auto negate() const -> Result<Value>;
+    [[nodiscard]] auto unaryPlus() const -> Result<Value>;
+
+    [[nodiscard]] auto lessThan(const Value& other) const -> Result<bool>;
+    [[nodiscard]] auto lessEqual(const Value& other) const -> Result<bool>;
+    [[nodiscard]] auto greaterThan(const Value& other) const -> Result<bool>;
+    [[nodiscard]] auto greaterEqual(const Value& other) const -> Result<bool>;
+
     [[nodiscard]] auto operator|(const Value& other) const -> Value;
     [[nodiscard]] auto operator^(const Value& other) const -> Value;
     [[nodiscard]] auto operator&(const Value& other) const -> Value;
@@ -199,27 +238,275 @@ private:
         Bool, Float, Int, None, String, Object,
     };
 
-    [[nodiscard]] auto typeInternal() const noexcept -> TypeInternal;
+    // concatenations at least this long are made lazily, see memory::SharedString
+    static constexpr auto s_minLazyConcatenation = 64_uz;
+
+    template<Primitive T>
+    auto store(T value) -> void
+    {
+        if constexpr (IsString<T>) {
+            storeString(std::string_view{value});
+        } else if constexpr (IsNone<T>) {
+            makeNone();
+        } else if constexpr (IsInteger<T>) {
+            storeInt(static_cast<i64>(value));
+        } else if constexpr (IsFloatingPoint<T>) {
+            storeFloat(static_cast<f64>(value));
+        } else if constexpr (IsBool<T>) {
+            storeBool(value);
+        }
+    }
+
+    auto storeString(std::string_view string, bool isConstant = false) -> void;
+    auto storeSharedString(memory::SharedString* string) noexcept -> void;
+
+    // the number of characters in a string, without flattening a lazy concatenation
+    [[nodiscard]] auto stringSize() const noexcept -> usize;
+    // a new reference to the string's SharedString, creating one if it's stored in the value
+    [[nodiscard]] auto retainSharedString() const -> memory::SharedString*;
+    [[nodiscard]] auto concatenate(const Value& other) const -> Value;
+
+    // takes a new reference to anything owned after the representation has been copied from another value
+    auto retain() -> void
+    {
+        if (ownsMemory()) {
+            retainOwned();
+        }
+    }
+
+    // drops anything owned, leaving the representation invalid until something is stored
+    auto release() noexcept -> void
+    {
+        if (ownsMemory()) {
+            releaseOwned();
+        }
+    }
+
+    auto retainOwned() -> void;
+    auto releaseOwned() noexcept -> void;
+
+#ifdef POISE_NAN_BOXING
+    // floats are stored as their bits, everything else is stored in the payload of a negative quiet NaN
+    // with the TypeInternal in the bits above it, real NaNs are canonicalised to a positive quiet NaN so
+    // they are never mistaken for a boxed value
+    static constexpr auto s_boxedBits = 0xFFF8'0000'0000'0000_u64;
+    static constexpr auto s_tagShift = 48_u64;
+    static constexpr auto s_tagMask = 0x7_u64;
+    static constexpr auto s_payloadMask = 0x0000'FFFF'FFFF'FFFF_u64;
+    static constexpr auto s_canonicalNaN = 0x7FF8'0000'0000'0000_u64;
+    // Ints that don't fit in the payload are stored on the heap under their own tag
+    static constexpr auto s_heapIntTag = 6_u64;
+    static constexpr auto s_minInlineInt = -(1_i64 << 47);
+    static constexpr auto s_maxInlineInt = (1_i64 << 47) - 1_i64;
+    // String, Object and heap Int tags are the highest, so one comparison tells us if a value owns anything
+    static constexpr auto s_ownershipThreshold = s_boxedBits | (static_cast<u64>(TypeInternal::String) << s_tagShift);
+
+    [[nodiscard]] static constexpr auto boxed(u64 tag, u64 payload) noexcept -> u64
+    {
+        return s_boxedBits | (tag << s_tagShift) | payload;
+    }
+
+    [[nodiscard]] auto isBoxed() const noexcept -> bool
+    {
+        return (m_bits & s_boxedBits) == s_boxedBits;
+    }
+
+    [[nodiscard]] auto tag() const noexcept -> u64
+    {
+        return (m_bits >> s_tagShift) & s_tagMask;
+    }
+
+    [[nodiscard]] auto payload() const noexcept -> u64
+    {
+        return m_bits & s_payloadMask;
+    }
+
+    [[nodiscard]] auto ownsMemory() const noexcept -> bool
+    {
+        return m_bits >= s_ownershipThreshold;
+    }
+
+    auto copyRepresentation(const Value& other) noexcept -> void
+    {
+        m_bits = other.m_bits;
+    }
+
+    auto makeNone() noexcept -> void
+    {
+        m_bits = boxed(static_cast<u64>(TypeInternal::None), 0_u64);
+    }
+
+    [[nodiscard]] auto typeInternal() const noexcept -> TypeInternal
+    {
+        if (!isBoxed()) {
+            return TypeInternal::Float;
+        }
+
+        const auto t = tag();
+        return t == s_heapIntTag ? TypeInternal::Int : static_cast<TypeInternal>(t);
+    }
+
+    [[nodiscard]] auto rawBool() const noexcept -> bool
+    {
+        return payload() != 0_u64;
+    }
+
+    [[nodiscard]] auto rawInt() const noexcept -> i64
+    {
+        if (tag() == s_heapIntTag) {
+            return *reinterpret_cast<const i64*>(payload());
+        }
+
+        // sign extend the payload
+        return static_cast<i64>(payload() << 16_u64) >> 16;
+    }
+
+    [[nodiscard]] auto rawFloat() const noexcept -> f64
+    {
+        return std::bit_cast<f64>(m_bits);
+    }
+
+    [[nodiscard]] auto rawObject() const noexcept -> objects::Object*
+    {
+        return reinterpret_cast<objects::Object*>(payload());
+    }
+
+    [[nodiscard]] auto sharedString() const noexcept -> memory::SharedString*
+    {
+        return reinterpret_cast<memory::SharedString*>(payload());
+    }
+
+    auto storeBool(bool value) noexcept -> void
+    {
+        m_bits = boxed(static_cast<u64>(TypeInternal::Bool), value ? 1_u64 : 0_u64);
+    }
+
+    auto storeInt(i64 value) -> void
+    {
+        if (value >= s_minInlineInt && value <= s_maxInlineInt) {
+            m_bits = boxed(static_cast<u64>(TypeInternal::Int), static_cast<u64>(value) & s_payloadMask);
+        } else {
+            m_bits = boxed(s_heapIntTag, reinterpret_cast<u64>(new i64{value}));
+        }
+    }
+
+    auto storeFloat(f64 value) noexcept -> void
+    {
+        m_bits = std::isnan(value) ? s_canonicalNaN : std::bit_cast<u64>(value);
+    }
+
+    auto storeObject(objects::Object* object) noexcept -> void
+    {
+        POISE_ASSERT((reinterpret_cast<u64>(object) & ~s_payloadMask) == 0_u64, "Pointer does not fit in a NaN-boxed value");
+        m_bits = boxed(static_cast<u64>(TypeInternal::Object), reinterpret_cast<u64>(object));
+    }
+
+    u64 m_bits;
+#else
+    [[nodiscard]] auto ownsMemory() const noexcept -> bool
+    {
+        return m_type == TypeInternal::Object || (m_type == TypeInternal::String && m_smallStringSize == s_notSmallString);
+    }
+
+    auto copyRepresentation(const Value& other) noexcept -> void
+    {
+        m_data = other.m_data;
+        m_type = other.m_type;
+        m_smallStringSize = other.m_smallStringSize;
+    }
+
+    auto makeNone() noexcept -> void
+    {
+        m_data.none = std::nullptr_t{};
+        m_type = TypeInternal::None;
+    }
+
+    [[nodiscard]] auto typeInternal() const noexcept -> TypeInternal
+    {
+        return m_type;
+    }
+
+    [[nodiscard]] auto rawBool() const noexcept -> bool
+    {
+        return m_data.boolean;
+    }
+
+    [[nodiscard]] auto rawInt() const noexcept -> i64
+    {
+        return m_data.integer;
+    }
+
+    [[nodiscard]] auto rawFloat() const noexcept -> f64
+    {
+        return m_data.floating;
+    }
+
+    [[nodiscard]] auto rawObject() const noexcept -> objects::Object*
+    {
+        return m_data.object;
+    }
+
+    // nullptr if the string is stored in the value
+    [[nodiscard]] auto sharedString() const noexcept -> memory::SharedString*
+    {
+        return m_smallStringSize == s_notSmallString ? m_data.sharedString : nullptr;
+    }
+
+    [[nodiscard]] auto smallStringWord() const noexcept -> u64
+    {
+        return std::bit_cast<u64>(m_data.smallString);
+    }
+
+    // strings that fit in the value are stored in it, so creating and copying them never allocates
+    static constexpr auto s_maxSmallString = sizeof(void*);
+    static constexpr auto s_notSmallString = u8{0xFF};
+
+    auto storeBool(bool value) noexcept -> void
+    {
+        m_type = TypeInternal::Bool;
+        m_data.boolean = value;
+    }
+
+    auto storeInt(i64 value) noexcept -> void
+    {
+        m_type = TypeInternal::Int;
+        m_data.integer = value;
+    }
+
+    auto storeFloat(f64 value) noexcept -> void
+    {
+        m_type = TypeInternal::Float;
+        m_data.floating = value;
+    }
+
+    auto storeObject(objects::Object* object) noexcept -> void
+    {
+        m_type = TypeInternal::Object;
+        m_data.object = object;
+    }
 
     union
     {
         objects::Object* object;
         std::nullptr_t none;
-#ifdef POISE_INTERN_STRINGS
-        usize string;
-#else
-        std::string* string;
-#endif
+        memory::SharedString* sharedString;
+        char smallString[s_maxSmallString];
         i64 integer;
         f64 floating;
         bool boolean;
     } m_data{};
 
     TypeInternal m_type;
-
-    [[nodiscard]] auto data() const noexcept -> decltype(m_data);
-    auto makeNone() noexcept -> void;
+    // sits in the padding after the type
+    u8 m_smallStringSize{};
+#endif
 };  // class Value
+
+#ifdef POISE_NAN_BOXING
+static_assert(sizeof(Value) == 8_uz, "NaN-boxed Value should be 8 bytes");
+#else
+static_assert(sizeof(Value) == 16_uz, "Value should be 16 bytes");
+#endif
 }   // namespace poise::runtime
 
 template<>
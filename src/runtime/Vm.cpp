@@ -6,85 +6,113 @@
 #include <fmt/color.h>
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <memory>
 #include <ranges>
-#include <stack>
 
 namespace poise::runtime {
 using namespace objects;
 using namespace objects::iterables;
 using namespace objects::iterables::hashables;
 
+namespace {
+// slots reserved for the value stack up front, enough that ordinary programs never reallocate it
+constexpr auto s_initialStackCapacity = 1_uz << 16;
+}   // namespace
+
 Vm::Vm(std::string mainFilePath)
     : m_mainFilePath{std::move(mainFilePath)}
     , m_typeLookup{
         {types::Type::Bool, Value::createObjectUntracked<Type>(types::Type::Bool, "Bool",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() > 1_uz) {
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::IncorrectArgCount,
                             fmt::format("Expected 1 or 0 args to Bool but got {}", args.size())
-                        };
+                        );
                     }
 
                     return !args.empty() && args[0_uz].toBool();
                 })},
         {types::Type::Float, Value::createObjectUntracked<Type>(types::Type::Float, "Float",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() > 1_uz) { 
-                        throw Exception{ 
+                        return error(
                             Exception::ExceptionType::IncorrectArgCount,
                             fmt::format("Expected 1 or 0 args to Float but got {}", args.size())
-                        }; 
+                        ); 
                     } 
 
-                    return args.empty() ? 0.0 : args[0_uz].toFloat();
+                    if (args.empty()) {
+                        return 0.0;
+                    }
+
+                    const auto result = args[0_uz].tryToFloat();
+                    if (!result) {
+                        return std::unexpected{result.error()};
+                    }
+
+                    return *result;
                 })},
         {types::Type::Int, Value::createObjectUntracked<Type>(types::Type::Int, "Int",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() > 1_uz) { 
-                        throw Exception{ 
+                        return error(
                             Exception::ExceptionType::IncorrectArgCount,
                             fmt::format("Expected 1 or 0 args to Int but got {}", args.size())
-                        }; 
+                        ); 
                     } 
 
-                    return args.empty() ? 0 : args[0_uz].toInt();
+                    if (args.empty()) {
+                        return 0;
+                    }
+
+                    const auto result = args[0_uz].tryToInt();
+                    if (!result) {
+                        return std::unexpected{result.error()};
+                    }
+
+                    return *result;
                 })},
         {types::Type::None, Value::createObjectUntracked<Type>(types::Type::None, "None",
-                [](std::span<Value> args) -> Value {
-                    return args.empty() 
-                        ? Value::none()
-                        : throw Exception{ 
+                [](std::span<Value> args) -> Result<Value> {
+                    if (!args.empty()) {
+                        return error(
                             Exception::ExceptionType::InvalidType,
                             fmt::format("Expected no args to construct None but got {}", args.size())
-                        };
+                        );
+                    }
+
+                    return Value::none();
                 })},
         {types::Type::String, Value::createObjectUntracked<Type>(types::Type::String, "String",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() > 1_uz) { 
-                        throw Exception{ 
+                        return error(
                             Exception::ExceptionType::IncorrectArgCount,
                             fmt::format("Expected 1 or 0 args to String but got {}", args.size())
-                        }; 
+                        ); 
                     } 
 
                     return args.empty() ? "" : args[0_uz].toString();
                 })},
         {types::Type::Dict, Value::createObjectUntracked<Type>(types::Type::Dict, "Dict",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     for (auto i = 0_uz; i < args.size(); i++) {
                         if (args[i].type() != types::Type::Tuple) {
-                            throw Exception{
+                            return error(
                                 Exception::ExceptionType::InvalidType,
                                 fmt::format("Expected all args to construct Dict to be Tuple, but got {} at position {}", args[i].type(), i)
-                            };
+                            );
                         }
                     }
 
                     return Value::createObject<Dict>(args);
                 })},
         {types::Type::Exception, Value::createObjectUntracked<Type>(types::Type::Exception, "Exception",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     switch (args.size()) {
                         case 0_uz: {
                             return Value::createObject<Exception>(Exception::ExceptionType::Exception);
@@ -103,10 +131,10 @@ Vm::Vm(std::string mainFilePath)
                         }
                         case 2_uz: {
                             if (args[0_uz].type() != types::Type::Int) {
-                                throw Exception{
+                                return error(
                                     Exception::ExceptionType::InvalidType,
                                     fmt::format("Expected Int at position 0 to construct Exception but got {}", args[0_uz].type())
-                                };
+                                );
                             }
 
                             const auto exceptionType =
@@ -117,20 +145,20 @@ Vm::Vm(std::string mainFilePath)
                             return Value::createObject<Exception>(exceptionType, args[1_uz].toString());
                         }
                         default: {
-                            throw Exception{
+                            return error(
                                 Exception::ExceptionType::IncorrectArgCount,
                                 fmt::format("Expected 2 args to construct Exception but got {}", args.size())
-                            };
+                            );
                         }
                     }
                 })},
         {types::Type::Function, Value::createObjectUntracked<Type>(types::Type::Function, "Function",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() != 1_uz) {
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::IncorrectArgCount,
                             fmt::format("Expected 1 arg to Function but got  {}", args.size())
-                        };
+                        );
                     }
 
                     if (const auto object = args[0_uz].object()) {
@@ -138,20 +166,20 @@ Vm::Vm(std::string mainFilePath)
                             return args[0_uz];
                         }
 
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::InvalidType,
                             fmt::format("Function can only be constructed from Function or Lambda but got {}", args[0_uz].type())
-                        };
+                        );
                     }
 
-                    throw Exception{
+                    return error(
                         Exception::ExceptionType::InvalidType,
                         "Function can only be constructed from Function or Lambda"
-                    };
+                    );
                 })},
         {types::Type::Iterator, Value::createObjectUntracked<Type>(types::Type::Iterator, "Iterator", nullptr)},
         {types::Type::List, Value::createObjectUntracked<Type>(types::Type::List, "List",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() == 1_uz) {
                         return Value::createObject<List>(std::move(args[0_uz]));
                     }
@@ -162,34 +190,34 @@ Vm::Vm(std::string mainFilePath)
                     });
                 })},
         {types::Type::Range, Value::createObjectUntracked<Type>(types::Type::Range, "Range",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     // last arg is whether the range is inclusive or not which is handled internally, user side it's 2 or 3 args
                     if (args.size() < 3_uz || args.size() > 4_uz) {
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::IncorrectArgCount,
                             fmt::format("Expected 2 or 3 args to Range but got {}", args.size())
-                        };
+                        );
                     }
 
                     if (args[0_uz].type() != types::Type::Int) {
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::InvalidType,
                             fmt::format("Expected Int for range start but got {}", args[0_uz].type())
-                        };
+                        );
                     }
 
                     if (args[1_uz].type() != types::Type::Int) {
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::InvalidType,
                             fmt::format("Expected Int for range end but got {}", args[1_uz].type())
-                        };
+                        );
                     }
 
                     if (args.size() == 4_uz && args[2_uz].type() != types::Type::Int) {
-                        throw Exception{
+                        return error(
                             Exception::ExceptionType::InvalidType,
                             fmt::format("Expected Int for range increment but got {}", args[2_uz].type())
-                        };
+                        );
                     }
 
                     if (args.size() == 4_uz) {
@@ -209,7 +237,7 @@ Vm::Vm(std::string mainFilePath)
                     );
                 })},
         {types::Type::Set, Value::createObjectUntracked<Type>(types::Type::Set, "Set",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     if (args.size() == 1_uz) {
                         return Value::createObject<Set>(std::move(args[0_uz]));
                     }
@@ -217,7 +245,7 @@ Vm::Vm(std::string mainFilePath)
                     return Value::createObject<Set>(args);
                 })},
         {types::Type::Tuple, Value::createObjectUntracked<Type>(types::Type::Tuple, "Tuple",
-                [](std::span<Value> args) -> Value {
+                [](std::span<Value> args) -> Result<Value> {
                     return Value::createObject<Tuple>(
                         std::vector<Value>{
                             std::make_move_iterator(args.begin()),
@@ -226,8 +254,8 @@ Vm::Vm(std::string mainFilePath)
                     );
                 })},
         {types::Type::Type, Value::createObjectUntracked<Type>(types::Type::Type, "Type",
-                []([[maybe_unused]] std::span<Value> args) -> Value {
-                    throw Exception(Exception::ExceptionType::InvalidType, "Cannot construct Type");
+                []([[maybe_unused]] std::span<Value> args) -> Result<Value> {
+                    return error(Exception::ExceptionType::InvalidType, "Cannot construct Type");
                 })},
     }
 
@@ -245,15 +273,16 @@ auto Vm::currentFunction() const noexcept -> Function*
     return m_currentFunction;
 }
 
-auto Vm::nativeFunctionHash(std::string_view functionName) const noexcept -> std::optional<NativeNameHash>
+auto Vm::nativeFunctionIndex(std::string_view functionName) const noexcept -> std::optional<NativeIndex>
 {
-    const auto hash = m_nativeNameHasher(functionName);
-    return m_nativeFunctionLookup.contains(hash) ? std::optional{hash} : std::nullopt;
+    const auto it = m_nativeFunctionLookup.find(m_nativeNameHasher(functionName));
+    return it != m_nativeFunctionLookup.end() ? std::optional{it->second} : std::nullopt;
 }
 
-auto Vm::nativeFunctionArity(NativeNameHash hash) const noexcept -> u8
+auto Vm::nativeFunctionArity(NativeIndex index) const noexcept -> u8
 {
-    return m_nativeFunctionLookup.at(hash).arity();
+    POISE_ASSERT(index < m_nativeFunctions.size(), "Native function out of range, there has been an error in codegen");
+    return m_nativeFunctions[index].arity();
 }
 
 auto Vm::namespaceManager() const noexcept -> const NamespaceManager*
@@ -271,49 +300,57 @@ auto Vm::typeValue(types::Type type) const noexcept -> const Value&
     return m_typeLookup.at(type);
 }
 
-auto Vm::emitOp(Op op, usize line) noexcept -> void
+auto Vm::currentChunk() noexcept -> Chunk*
 {
-    if (m_currentFunction == nullptr) {
-        m_globalOps.push_back({op, line});
-    } else {
-        m_currentFunction->emitOp(op, line);
-    }
+    return m_currentFunction == nullptr ? &m_globalChunk : &m_currentFunction->chunk();
 }
 
-auto Vm::emitConstant(Value value) noexcept -> void
+auto Vm::setRegisterOps(bool registerOps) noexcept -> void
 {
-    if (m_currentFunction == nullptr) {
-        m_globalConstants.emplace_back(std::move(value));
-    } else {
-        m_currentFunction->emitConstant(std::move(value));
-    }
+    m_registerOps = registerOps;
+}
+
+auto Vm::registerOps() const noexcept -> bool
+{
+    return m_registerOps;
+}
+
+auto Vm::addLinkSite(LinkSite linkSite) noexcept -> void
+{
+    m_linkSites.emplace_back(std::move(linkSite));
+}
+
+auto Vm::linkSites() const noexcept -> std::span<const LinkSite>
+{
+    return m_linkSites;
 }
 
-auto Vm::run() const noexcept -> RunResult
+auto Vm::run() noexcept -> RunResult
 {
+    // locals and temporaries share one stack, a frame's locals start at its localIndexOffset with the
+    // arguments passed to it, so a call leaves its arguments where they are and they become the callee's first locals
+    // locals are only declared at statement level where the frame has no temporaries, so a declared local's
+    // value is already in its slot when it is declared
     std::vector<Value> stack;
-    std::vector<Value> localVariables;
+    stack.reserve(s_initialStackCapacity);
 
     struct CallStackEntry
     {
-        usize localIndexOffset;
-        usize opIndex;
-        usize constantIndex;
+        usize localIndexOffset; // index of the frame's first local in the stack
+        usize returnStackSize;  // the stack is truncated to this on return, dropping the frame and the callee below it if there is one
+        usize ip;   // offset into the callee's code, for the caller this is just after the call site
 
         usize heldIteratorsSize;
 
-        usize callSiteLine;
-
         Function* callerFunction;
         Function* calleeFunction;
     };
 
     std::vector<CallStackEntry> callStack{{
         .localIndexOffset = 0_uz,
-        .opIndex = 0_uz,
-        .constantIndex = 0_uz,
+        .returnStackSize = 0_uz,
+        .ip = 0_uz,
         .heldIteratorsSize = 0_uz,
-        .callSiteLine = 0_uz,
         .callerFunction = nullptr,
         .calleeFunction = nullptr,
     }};
@@ -322,14 +359,19 @@ auto Vm::run() const noexcept -> RunResult
     {
         usize stackSize;
         usize callStackSize;
-        usize constantIndexToJumpTo;
-        usize opIndexToJumpTo;
+        usize ipToJumpTo;
         usize heldIteratorsSize;
     };
 
-    std::stack<TryBlockState> tryBlockStateStack;
+    // try blocks need no state at run time, but a try expression can be anywhere in an expression
+    // so the stack it should unwind to is only known when it is entered
+    std::vector<TryBlockState> tryBlockStateStack;
     std::vector<Value> heldIterators;
 
+    // upvalues for captured variables that are still on the stack, ordered by slot
+    // so the ones that need closing when the stack shrinks are always at the back
+    std::vector<std::shared_ptr<Function::Upvalue>> openUpvalues;
+
     auto pop = [&stack] () -> Value {
         POISE_ASSERT(!stack.empty(), "Stack is empty, there has been an error in codegen");
         auto value = std::move(stack.back());
@@ -375,12 +417,6 @@ auto Vm::run() const noexcept -> RunResult
             }
         }
 
-        for (const auto& value : localVariables) {
-            if (auto object = value.object()) {
-                memory::Gc::instance().markRoot(object);
-            }
-        }
-
         for (const auto& iterator : heldIterators) {
             memory::Gc::instance().markRoot(iterator.object());
         }
@@ -397,280 +433,625 @@ auto Vm::run() const noexcept -> RunResult
     };
 
 #ifdef POISE_DEBUG
-    auto printMemory = [&stack, &localVariables] {
+    auto printMemory = [&stack] {
         // I'm assuming this gets yeeted in release...
         // fmt::print("STACK:\n");
         // for (const auto& value : stack) {
         //     fmt::print("\t{}\n", value);
         // }
-        // fmt::print("LOCALS:\n");
-        // for (const auto& local : localVariables) {
-        //     fmt::print("\t{}\n", local);
-        // }
     };
 #else
     auto printMemory = []{};
 #endif
 
-    while (true) {
+    auto gcSafepoint = [&] {
         if (memory::Gc::instance().shouldCleanCycles()) {
             markGcRoots();
             memory::Gc::instance().cleanCycles();
         }
+    };
+
+    // the state of the current frame is kept in locals so the compiler can hold it in registers,
+    // it is only written back to the call stack when a new frame is pushed
+    Function* currentFunction = nullptr;
+    u8* code = nullptr;
+    const Value* constants = nullptr;
+    usize localIndexOffset = 0_uz;
+    const u8* ip = nullptr;
+    const u8* opStart = nullptr;
+
+    auto loadFrame = [&] {
+        const auto& frame = callStack.back();
+        currentFunction = frame.calleeFunction;
+        auto& chunk = currentFunction ? currentFunction->chunk() : m_globalChunk;
+        code = chunk.code().data();
+        constants = chunk.constants().data();
+        localIndexOffset = frame.localIndexOffset;
+        ip = code + frame.ip;
+    };
+
+    auto saveFrame = [&] {
+        callStack.back().ip = static_cast<usize>(ip - code);
+    };
+
+    // the upvalue for the variable in the given slot, shared with any other lambda that has captured it
+    auto captureSlot = [&] (usize slot) -> std::shared_ptr<Function::Upvalue> {
+        const auto it = std::ranges::lower_bound(openUpvalues, slot, {}, [] (const auto& upvalue) -> usize {
+            return upvalue->slot;
+        });
+
+        if (it != openUpvalues.end() && (*it)->slot == slot) {
+            return *it;
+        }
+
+        return *openUpvalues.insert(it, std::make_shared<Function::Upvalue>(Function::Upvalue{.slot = slot}));
+    };
+
+    // a closed upvalue isn't an object the Gc can remember, so a young value stored in one is remembered itself
+    auto rememberUpvalueValue = [] (const Value& value) {
+        if (const auto object = value.object(); object != nullptr && object->young()) {
+            memory::Gc::instance().rememberObject(object);
+        }
+    };
+
+    // must be called before the stack shrinks below any variable that might have been captured
+    auto closeUpvalues = [&] (usize fromSlot) {
+        while (!openUpvalues.empty() && openUpvalues.back()->slot >= fromSlot) {
+            auto& upvalue = *openUpvalues.back();
+            upvalue.value = stack[upvalue.slot];
+            rememberUpvalueValue(upvalue.value);
+            upvalue.isOpen = false;
+            openUpvalues.pop_back();
+        }
+    };
+
+    auto arityError = [] (const Function* function, usize numArgs) -> std::optional<Error> {
+        // if the function has a pack, numParams can be >= arity
+        if (function->hasVariadicParams()) {
+            if (numArgs < function->arity()) {
+                return Error{
+                    Exception::ExceptionType::IncorrectArgCount,
+                    fmt::format("Function '{}' takes >={} args but was given {}", function->name(), function->arity(), numArgs)
+                };
+            }
+        } else if (numArgs != function->arity()) {
+            return Error{
+                Exception::ExceptionType::IncorrectArgCount,
+                fmt::format("Function '{}' takes {} args but was given {}", function->name(), function->arity(), numArgs)
+            };
+        }
 
-        auto& callStackTop = callStack.back();
+        return {};
+    };
+
+    auto packVariadicParams = [&] (const Function* function, usize argsStart) {
+        if (function->hasVariadicParams()) {
+            const auto packStart = argsStart + function->arity() - 1_uz;
+            std::vector<Value> variadicParams{
+                std::make_move_iterator(stack.begin() + static_cast<isize>(packStart)),
+                std::make_move_iterator(stack.end())
+            };
+            stack.resize(packStart);
+            stack.emplace_back(Value::createObject<List>(std::move(variadicParams)));
+        }
+    };
+
+    // the top numArgs values on the stack are the args, they stay where they are and become the callee's first locals,
+    // the callee is below them if it was called as a value rather than directly
+    auto pushFrame = [&] (Function* function, usize numArgs, bool calleeOnStack) {
+        const auto argsStart = stack.size() - numArgs;
+        packVariadicParams(function, argsStart);
+
+        saveFrame();
+        callStack.push_back({
+            .localIndexOffset = argsStart,
+            .returnStackSize = calleeOnStack ? argsStart - 1_uz : argsStart,
+            .ip = 0_uz,
+            .heldIteratorsSize = heldIterators.size(),
+            .callerFunction = currentFunction,
+            .calleeFunction = function,
+        });
+        loadFrame();
+    };
+
+    // a call in tail position, the callee and args are moved down to where the current frame starts and the frame
+    // is reused for the callee, so the call stack doesn't grow and the callee returns straight to our caller
+    auto replaceFrame = [&] (Function* function, usize numArgs, bool calleeOnStack) {
+        auto& frame = callStack.back();
+        POISE_ASSERT(
+            (tryBlockStateStack.empty() || tryBlockStateStack.back().callStackSize != callStack.size())
+                && currentFunction->chunk().findExceptionHandler(static_cast<usize>(opStart - code)) == nullptr,
+            "Tail call inside a try block, there has been an error in codegen"
+        );
+
+        while (heldIterators.size() != frame.heldIteratorsSize) {
+            heldIterators.pop_back();
+        }
+
+        closeUpvalues(frame.returnStackSize);
+
+        const auto moveFrom = stack.size() - numArgs - (calleeOnStack ? 1_uz : 0_uz);
+        const auto newSize = frame.returnStackSize + stack.size() - moveFrom;
+        std::move(
+            stack.begin() + static_cast<isize>(moveFrom),
+            stack.end(),
+            stack.begin() + static_cast<isize>(frame.returnStackSize)
+        );
+        stack.resize(newSize);
+
+        const auto argsStart = newSize - numArgs;
+        packVariadicParams(function, argsStart);
+
+        frame.localIndexOffset = argsStart;
+        frame.ip = 0_uz;
+        frame.calleeFunction = function;
+        loadFrame();
+    };
+
+    // quickening, generic arithmetic and comparison ops rewrite themselves in place to a version specialised
+    // for the operand types they see, and the specialised version rewrites itself back if its guard fails
+    auto rewriteOp = [&] (Op op) {
+        code[opStart - code] = static_cast<u8>(op);
+    };
+
+    auto quicken = [&] (const Value& a, const Value& b, Op intOp, Op floatOp) {
+        if (a.isInt() && b.isInt()) {
+            rewriteOp(intOp);
+        } else if (a.isFloat() && b.isFloat()) {
+            rewriteOp(floatOp);
+        }
+    };
+
+    auto peekTwo = [&stack] () -> std::tuple<const Value&, const Value&> {
+        POISE_ASSERT(stack.size() >= 2_uz, "Stack is not big enough, there has been an error in codegen");
+        return {stack[stack.size() - 2_uz], stack.back()};
+    };
+
+    auto replaceTopTwo = [&stack] (Value result) {
+        stack.pop_back();
+        stack.back() = std::move(result);
+    };
+
+    auto readRegister = [&] (u32 operand) -> Value {
+        if (operand == RegisterStack) {
+            return pop();
+        }
+
+        if (operand & RegisterConstantBit) {
+            return constants[operand & ~RegisterConstantBit];
+        }
+
+        return stack[operand + localIndexOffset];
+    };
+
+    // reads the left and right hand side operands of a three-address op
+    auto readRegisters = [&] () -> std::tuple<Value, Value> {
+        const auto lhsOperand = readOperand<u32>(ip);
+        const auto rhsOperand = readOperand<u32>(ip);
+        // if both are on the stack the right hand side is on top
+        auto rhs = readRegister(rhsOperand);
+        auto lhs = readRegister(lhsOperand);
+        return {std::move(lhs), std::move(rhs)};
+    };
 
-        const auto localIndexOffset = callStackTop.localIndexOffset;
-        auto& opIndex = callStackTop.opIndex;
-        auto& constantIndex = callStackTop.constantIndex;
+    // writes the result of a three-address op to its destination operand
+    auto writeRegister = [&] (Value result) {
+        const auto destination = readOperand<u32>(ip);
+        if (destination == RegisterStack) {
+            stack.push_back(std::move(result));
+        } else {
+            stack[destination + localIndexOffset] = std::move(result);
+        }
+    };
+
+    // the exception currently being raised, pushed for the catch block of the innermost try block
+    Value raisedException;
+
+    // unwinds to the innermost try block ready for the catch block to run,
+    // or reports the exception and returns false if it isn't inside one
+    auto catchRaisedException = [&] () -> bool {
+        // work outwards from the current frame, in each frame the innermost try is a try expression if one is
+        // being evaluated, since it can't contain a try block in the same frame, otherwise the innermost try block
+        // covering the frame's current op
+        for (auto callStackSize = callStack.size(); callStackSize > 0_uz; callStackSize--) {
+            if (!tryBlockStateStack.empty() && tryBlockStateStack.back().callStackSize == callStackSize) {
+                const auto [stackSize, _, ipToJumpTo, heldIteratorsSize] = tryBlockStateStack.back();
+
+                callStack.resize(callStackSize);
+                callStack.back().ip = ipToJumpTo;
+
+                while (heldIterators.size() != heldIteratorsSize) {
+                    heldIterators.pop_back();
+                }
+
+                tryBlockStateStack.pop_back();
+
+                closeUpvalues(stackSize);
+                stack.resize(stackSize);
+                stack.push_back(std::move(raisedException));
+                return true;
+            }
+
+            auto& frame = callStack[callStackSize - 1_uz];
+            const auto& chunk = frame.calleeFunction ? frame.calleeFunction->chunk() : m_globalChunk;
+            // the current frame's ip hasn't been saved, and a caller's ip is just past its call instruction
+            const auto offset = callStackSize == callStack.size() ? static_cast<usize>(opStart - code) : frame.ip - 1_uz;
+            if (const auto handler = chunk.findExceptionHandler(offset)) {
+                callStack.resize(callStackSize);
+                frame.ip = handler->target;
 
-        const auto currentFunction = callStackTop.calleeFunction;
+                while (heldIterators.size() != frame.heldIteratorsSize + handler->numHeldIterators) {
+                    heldIterators.pop_back();
+                }
+
+                const auto stackSize = frame.localIndexOffset + handler->numLocals;
+                closeUpvalues(stackSize);
+                stack.resize(stackSize);
+                stack.push_back(std::move(raisedException));
+                return true;
+            }
+        }
+
+        print(stderr, fmt::emphasis::bold | fg(fmt::color::red), "Runtime Error: ");
+        fmt::print(stderr, "{}\n", raisedException.object()->toString());
+
+        if (currentFunction != nullptr) {
+            const auto line = currentFunction->chunk().lineAt(static_cast<usize>(opStart - code));
+            fmt::print(stderr, "  At {}:{} in function '{}'\n", currentFunction->filePath().string(), line, currentFunction->name());
+            fmt::print(stderr, "    {}\n", scanner::Scanner::getCodeAtLine(currentFunction->filePath(), line));
+        } else  {
+            fmt::print(stderr, "  At entry\n");
+        }
+
+        for (auto i = callStack.size() - 1_uz; i > 0_uz; i--) {
+            if (const auto caller = callStack[i].callerFunction) {
+                // the caller's ip is just past its call instruction
+                const auto callSiteLine = caller->chunk().lineAt(callStack[i - 1_uz].ip - 1_uz);
+                fmt::print(stderr, "  At {}:{} in function '{}'\n", caller->filePath().string(), callSiteLine, caller->name());
+                fmt::print(stderr, "    {}\n", scanner::Scanner::getCodeAtLine(caller->filePath(), callSiteLine));
+            }
+        }
 
-        const auto opList = currentFunction ? currentFunction->opList() : m_globalOps;
-        const auto constantList = currentFunction ? currentFunction->constantList() : m_globalConstants;
+        fmt::print(stderr, "\nThis is an exception thrown by the runtime as a result of a problem in your poise code that has not been caught.\n");
+        fmt::print(stderr, "Consider reviewing your code or catching this exception with a `try/catch` statement.\n");
+        return false;
+    };
 
-        const auto [op, line] = opList[opIndex++];
+#ifdef POISE_GCC_CLANG
+    // computed goto, each handler jumps straight to the next one which gives the branch predictor one
+    // indirect branch per handler to learn from rather than a single shared one at the top of a switch
+    // labels as values are a GNU extension, the diagnostic is popped at the end of the function
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    // must be kept in the same order as the Op enum
+    static const void* const dispatchTable[] = {
+        &&op_AssignLocal,
+        &&op_AssignUpvalue,
+        &&op_CaptureLocal,
+        &&op_CaptureUpvalue,
+        &&op_ConstructBuiltin,
+        &&op_DeclareLocalsWithUnpack,
+        &&op_EnterTry,
+        &&op_ExitTry,
+        &&op_LoadUpvalue,
+        &&op_LoadConstant,
+        &&op_LoadDirect,
+        &&op_LoadLocal,
+        &&op_LoadMember,
+        &&op_LoadType,
+        &&op_Pop,
+        &&op_PopIterator,
+        &&op_PopLocals,
+        &&op_Throw,
+        &&op_Unpack,
+        &&op_TypeOf,
+        &&op_Assert,
+        &&op_Print,
+        &&op_LogicOr,
+        &&op_LogicAnd,
+        &&op_BitwiseOr,
+        &&op_BitwiseXor,
+        &&op_BitwiseAnd,
+        &&op_Equal,
+        &&op_NotEqual,
+        &&op_LessThan,
+        &&op_LessEqual,
+        &&op_GreaterThan,
+        &&op_GreaterEqual,
+        &&op_LeftShift,
+        &&op_RightShift,
+        &&op_Addition,
+        &&op_Subtraction,
+        &&op_Multiply,
+        &&op_Divide,
+        &&op_Modulus,
+        &&op_LogicNot,
+        &&op_BitwiseNot,
+        &&op_Negate,
+        &&op_Plus,
+        &&op_MakeLambda,
+        &&op_AssignIndex,
+        &&op_LoadIndex,
+        &&op_LoadLocalLoadConstant,
+        &&op_LoadLocalLoadLocal,
+        &&op_LessThanJumpIfFalse,
+        &&op_AddRegisters,
+        &&op_SubtractRegisters,
+        &&op_MultiplyRegisters,
+        &&op_DivideRegisters,
+        &&op_ModulusRegisters,
+        &&op_EqualRegisters,
+        &&op_NotEqualRegisters,
+        &&op_LessThanRegisters,
+        &&op_LessEqualRegisters,
+        &&op_GreaterThanRegisters,
+        &&op_GreaterEqualRegisters,
+        &&op_AddIntInt,
+        &&op_AddFloatFloat,
+        &&op_SubtractIntInt,
+        &&op_SubtractFloatFloat,
+        &&op_MultiplyIntInt,
+        &&op_MultiplyFloatFloat,
+        &&op_LessThanIntInt,
+        &&op_LessThanFloatFloat,
+        &&op_LessEqualIntInt,
+        &&op_LessEqualFloatFloat,
+        &&op_GreaterThanIntInt,
+        &&op_GreaterThanFloatFloat,
+        &&op_GreaterEqualIntInt,
+        &&op_GreaterEqualFloatFloat,
+        &&op_Call,
+        &&op_CallDirect,
+        &&op_CallNative,
+        &&op_TailCall,
+        &&op_TailCallDirect,
+        &&op_Exit,
+        &&op_ForRangeInit,
+        &&op_ForRangeStep,
+        &&op_IncrementIterator,
+        &&op_InitIterator,
+        &&op_Jump,
+        &&op_JumpIfFalse,
+        &&op_JumpIfTrue,
+        &&op_Return,
+    };
+    static_assert(std::size(dispatchTable) == static_cast<usize>(Op::Return) + 1_uz, "Dispatch table does not cover every op");
+
+// a computed goto doesn't run the destructors of the scopes it leaves, so a handler that owns locals
+// keeps them in an inner block that has closed by the time it dispatches
+#define POISE_VM_CASE(name) op_##name
+#define POISE_VM_DISPATCH() opStart = ip; goto *dispatchTable[*ip++]
+#define POISE_VM_LOOP_BEGIN() POISE_VM_DISPATCH();
+#define POISE_VM_LOOP_END()
+#else
+#define POISE_VM_CASE(name) case Op::name
+#define POISE_VM_DISPATCH() continue
+#define POISE_VM_LOOP_BEGIN() while (true) { opStart = ip; switch (static_cast<Op>(*ip++)) {
+#define POISE_VM_LOOP_END() } }
+#endif
+// runtime errors are raised by jumping to the handler below rather than throwing,
+// throws from deeper in the runtime are still caught and take the same path
+#define POISE_VM_RAISE(exceptionType, message) \
+    do { raisedException = Value::createObject<Exception>(exceptionType, message); goto raiseException; } while (false)
+#define POISE_VM_RAISE_ERROR(error) POISE_VM_RAISE((error).exceptionType, std::move((error).message))
 
+    while (true) {
         try {
-            switch (op) {
-                case Op::AssignLocal: {
-                    const auto index = constantList[constantIndex++].value<usize>();
-                    localVariables[index + localIndexOffset] = pop();
-                    break;
-                }
-                case Op::CaptureLocal: {
-                    auto& lambda = stack.back();
-                    const auto index = constantList[constantIndex++].value<usize>();
-                    const auto& local = localVariables[index + localIndexOffset];
-                    lambda.object()->asFunction()->addCapture(local);
-                    break;
-                }
-                case Op::ConstructBuiltin: {
-                    const auto type = static_cast<types::Type>(constantList[constantIndex++].value<u8>());
-                    auto numArgs = constantList[constantIndex++].value<usize>();
-                    const auto hasUnpack = constantList[constantIndex++].value<bool>();
+            loadFrame();
+
+            POISE_VM_LOOP_BEGIN()
+            POISE_VM_CASE(AssignLocal): {
+                const auto index = readOperand<u32>(ip);
+                stack[index + localIndexOffset] = pop();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(AssignUpvalue): {
+                auto& upvalue = *currentFunction->upvalue(readOperand<u32>(ip));
+                if (upvalue.isOpen) {
+                    stack[upvalue.slot] = pop();
+                } else {
+                    upvalue.value = pop();
+                    rememberUpvalueValue(upvalue.value);
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(CaptureLocal): {
+                {
+                    const auto index = readOperand<u32>(ip);
+                    auto upvalue = captureSlot(index + localIndexOffset);
+                    stack.back().object()->asFunction()->addUpvalue(std::move(upvalue));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(CaptureUpvalue): {
+                const auto& upvalue = currentFunction->upvalue(readOperand<u32>(ip));
+                stack.back().object()->asFunction()->addUpvalue(upvalue);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(ConstructBuiltin): {
+                {
+                    const auto type = static_cast<types::Type>(readOperand<u8>(ip));
+                    auto numArgs = static_cast<usize>(readOperand<u8>(ip));
+                    const auto hasUnpack = readOperand<bool>(ip);
+                    const auto inclusiveRange = readOperand<bool>(ip);
 
                     if (hasUnpack) {
                         numArgs += pop().value<usize>() - 1_uz; // -1 for the pack, replace it with the size of the pack
                     }
 
-                    auto args = popCallArgs(numArgs);
-
                     if (type == types::Type::Range) {
-                        const auto inclusiveRange = constantList[constantIndex++].value<bool>();
-                        args.emplace_back(inclusiveRange);
+                        stack.emplace_back(inclusiveRange);
+                        numArgs++;
                     }
 
-                    stack.emplace_back(typeValue(type).object()->asType()->construct(args));
-                    break;
-                }
-                case Op::DeclareLocal: {
-                    auto value = pop();
-                    localVariables.emplace_back(std::move(value));
-                    break;
-                }
-                case Op::DeclareLocalsWithUnpack: {
-                    const auto hadUnpack = constantList[constantIndex++].value<bool>();
-                    const auto numDeclarations = constantList[constantIndex++].value<usize>();
-                    const auto numExpressions = constantList[constantIndex++].value<usize>();
-
-                    if (hadUnpack) {
-                        // there was an unpack and 0 or more regular expressions
-                        const auto numUnpacked = pop().value<usize>();
-                        const auto numValues = numUnpacked + numExpressions - 1_uz;
-                        if (numValues != numDeclarations) {
-                            throw Exception(
-                                Exception::ExceptionType::IncorrectArgCount,
-                                fmt::format(
-                                    "Expected {} values to assign but got {}",
-                                    numDeclarations,
-                                    numUnpacked + numExpressions - 1_uz
-                                )
-                            );
-                        }
-
-                        auto values = popCallArgs(numValues);
-                        for (auto& value : values) {
-                            localVariables.emplace_back(std::move(value));
-                        }
-                    } else {
-                        auto values = popCallArgs(numExpressions);
-                        for (auto& value : values) {
-                            localVariables.emplace_back(std::move(value));
-                        }
+                    // construct from the args where they are on the stack, then replace them with the result
+                    const auto argsStart = stack.size() - numArgs;
+                    auto result = typeValue(type).object()->asType()->construct(std::span{stack.data() + argsStart, numArgs});
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
                     }
 
-                    break;
+                    stack.resize(argsStart);
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::EnterTry: {
-                    const auto constantIndexToJumpTo = constantList[constantIndex++].value<usize>();
-                    const auto opIndexToJumpTo = constantList[constantIndex++].value<usize>();
-
-                    tryBlockStateStack.push({
-                        .stackSize = stack.size(),
-                        .callStackSize = callStack.size(),
-                        .constantIndexToJumpTo = constantIndexToJumpTo,
-                        .opIndexToJumpTo = opIndexToJumpTo,
-                        .heldIteratorsSize = heldIterators.size(),
-                    });
-                    break;
-                }
-                case Op::ExitTry: {
-                    tryBlockStateStack.pop();
-                    break;
-                }
-                case Op::LoadCapture: {
-                    // captures need to be inserted before call args
-                    const auto index = constantList[constantIndex++].value<usize>();
-                    const auto& capture = currentFunction->getCapture(index);
-                    const auto insertionIdx = localVariables.size() - currentFunction->arity();
-                    localVariables.insert(localVariables.begin() + static_cast<isize>(insertionIdx), capture);
-                    break;
-                }
-                case Op::LoadConstant: {
-                    stack.push_back(constantList[constantIndex++]);
-                    break;
-                }
-                case Op::LoadFunctionOrStruct: {
-                    const auto namespaceHash = constantList[constantIndex++].value<usize>();
-                    const auto typeNameHash = constantList[constantIndex++].value<usize>();
-                    const auto& typeName = memory::findInternedString(typeNameHash);
-
-                    if (auto function = m_namespaceManager.namespaceFunction(namespaceHash, typeNameHash)) {
-                        if (currentFunction != nullptr
-                            && namespaceHash != currentFunction->namespaceHash()
-                            && !function->object()->asFunction()->exported()) {
-                            throw Exception{
-                                Exception::ExceptionType::TypeNotExported,
-                                fmt::format(
-                                    "Function '{}' in namespace '{}' is not exported",
-                                    typeName,
-                                    m_namespaceManager.namespaceDisplayName(namespaceHash)
-                                )
-                            };
-                        }
-
-                        stack.push_back(std::move(*function));
-                    } else if (auto structure = m_namespaceManager.namespaceStruct(namespaceHash, typeNameHash)) {
-                        if (currentFunction != nullptr
-                            && namespaceHash != currentFunction->namespaceHash()
-                            && !structure->object()->asStruct()->exported()) {
-                            throw Exception{
-                                Exception::ExceptionType::TypeNotExported,
-                                fmt::format(
-                                    "Struct '{}' in namespace '{}' is not exported",
-                                    typeName,
-                                    m_namespaceManager.namespaceDisplayName(namespaceHash)
-                                )
-                            };
-                        }
-
-                        stack.push_back(std::move(*structure));
-                    } else {
-                        throw Exception{
-                            Exception::ExceptionType::TypeNotFound,
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(DeclareLocalsWithUnpack): {
+                const auto hadUnpack = readOperand<bool>(ip);
+                const auto numDeclarations = static_cast<usize>(readOperand<u32>(ip));
+                const auto numExpressions = static_cast<usize>(readOperand<u32>(ip));
+
+                // the values are already in their slots, only the count of the unpack has to go
+                if (hadUnpack) {
+                    // there was an unpack and 0 or more regular expressions
+                    const auto numUnpacked = pop().value<usize>();
+                    if (numUnpacked + numExpressions - 1_uz != numDeclarations) {
+                        POISE_VM_RAISE(
+                            Exception::ExceptionType::IncorrectArgCount,
                             fmt::format(
-                                "Type '{}' not found in namespace '{}'",
-                                typeName,
-                                m_namespaceManager.namespaceDisplayName(namespaceHash)
+                                "Expected {} values to assign but got {}",
+                                numDeclarations,
+                                numUnpacked + numExpressions - 1_uz
                             )
-                        };
+                        );
                     }
-
-                    break;
                 }
-                case Op::LoadLocal: {
-                    const auto& localIndex = constantList[constantIndex++];
-                    const auto& localValue = localVariables[localIndex.value<usize>() + localIndexOffset];
-                    stack.push_back(localValue);
-                    break;
-                }
-                case Op::LoadMember: {
+
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(EnterTry): {
+                const auto ipToJumpTo = readOperand<u32>(ip);
+
+                tryBlockStateStack.push_back({
+                    .stackSize = stack.size(),
+                    .callStackSize = callStack.size(),
+                    .ipToJumpTo = ipToJumpTo,
+                    .heldIteratorsSize = heldIterators.size(),
+                });
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(ExitTry): {
+                tryBlockStateStack.pop_back();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadUpvalue): {
+                const auto& upvalue = *currentFunction->upvalue(readOperand<u32>(ip));
+                stack.push_back(upvalue.isOpen ? stack[upvalue.slot] : upvalue.value);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadConstant): {
+                stack.push_back(constants[readOperand<u32>(ip)]);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadDirect): {
+                stack.push_back(Value::fromObject(std::bit_cast<objects::Object*>(readOperand<usize>(ip))));
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadLocal): {
+                const auto localIndex = readOperand<u32>(ip);
+                const auto& localValue = stack[localIndex + localIndexOffset];
+                stack.push_back(localValue);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadMember): {
+                {
                     // TODO: class member variables
                     auto value = pop();
 
-                    const auto memberNameHash = constantList[constantIndex++].value<usize>();
-                    const auto& memberName = memory::findInternedString(memberNameHash);
-                    const auto pushParentBack = constantList[constantIndex++].toBool();
-
-                    const auto type = typeValue(value.type()).object()->asType();
+                    const auto memberNameHash = readOperand<usize>(ip);
+                    const auto pushParentBack = readOperand<bool>(ip);
+                    auto& cache = currentFunction->chunk().memberCache(readOperand<u32>(ip));
 
-                    if (auto function = type->findExtensionFunction(memberNameHash)) {
-                        if (const auto p = function->object()->asFunction(); currentFunction->namespaceHash() != p->namespaceHash()) {
-                            if (!m_namespaceManager.namespaceHasImportedNamespace(currentFunction->namespaceHash(), p->namespaceHash())) {
-                                throw Exception{
-                                    Exception::ExceptionType::TypeNotFound,
-                                    fmt::format("Extension function '{}' not found for type '{}' - are you missing an import?", p->name(), type->typeName())
-                                };
+                    // the cache only holds functions that were found and imported, so a hit skips both checks
+                    if (const auto cachedFunction = cache.find(value.type())) {
+                        stack.push_back(*cachedFunction);
+                    } else {
+                        const auto type = typeValue(value.type()).object()->asType();
+
+                        if (auto function = type->findExtensionFunction(memberNameHash)) {
+                            if (const auto p = function->object()->asFunction(); currentFunction->namespaceHash() != p->namespaceHash()) {
+                                if (!m_namespaceManager.namespaceHasImportedNamespace(currentFunction->namespaceHash(), p->namespaceHash())) {
+                                    POISE_VM_RAISE(
+                                        Exception::ExceptionType::TypeNotFound,
+                                        fmt::format("Extension function '{}' not found for type '{}' - are you missing an import?", p->name(), type->typeName())
+                                    );
+                                }
                             }
+                            cache.add(value.type(), *function);
+                            stack.push_back(std::move(*function));
+                        } else {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::TypeNotFound,
+                                fmt::format("Function '{}' not defined for type '{}'", memory::findInternedString(memberNameHash), type->typeName())
+                            );
                         }
-                        stack.push_back(std::move(*function));
-                        if (pushParentBack) {
-                            stack.push_back(std::move(value));
-                        }
-                    } else {
-                        throw Exception{
-                            Exception::ExceptionType::TypeNotFound,
-                            fmt::format("Function '{}' not defined for type '{}'", memberName, type->typeName())
-                        };
                     }
-                    break;
-                }
-                case Op::LoadType: {
-                    const auto type = static_cast<types::Type>(constantList[constantIndex++].value<u8>());
-                    stack.push_back(typeValue(type));
-                    break;
-                }
-                case Op::Pop: {
-                    pop();
-                    break;
-                }
-                case Op::PopIterator: {
-                    heldIterators.pop_back();
-                    break;
+
+                    if (pushParentBack) {
+                        stack.push_back(std::move(value));
+                    }
                 }
-                case Op::PopLocals: {
-                    const auto numLocalsToRemain = constantList[constantIndex++].value<usize>();
-                    localVariables.resize(numLocalsToRemain + localIndexOffset);
-                    break;
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadType): {
+                const auto type = static_cast<types::Type>(readOperand<u8>(ip));
+                stack.push_back(typeValue(type));
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Pop): {
+                pop();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(PopIterator): {
+                heldIterators.pop_back();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(PopLocals): {
+                const auto numLocalsToRemain = static_cast<usize>(readOperand<u32>(ip));
+                closeUpvalues(numLocalsToRemain + localIndexOffset);
+                stack.resize(numLocalsToRemain + localIndexOffset);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Throw): {
+                auto value = pop();
+                if (value.type() != types::Type::Exception) {
+                    POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("Only Exceptions can be thrown"));
                 }
-                case Op::Throw: {
-                    auto value = pop();
-                    if (value.type() != types::Type::Exception) {
-                        throw Exception(Exception::ExceptionType::InvalidType, fmt::format("Only Exceptions can be thrown"));
-                    }
 
-                    const auto exception = value.object()->asException();
-                    throw Exception(exception->exceptionType(), std::string{exception->message()});
-                }
-                case Op::Unpack: {
+                raisedException = std::move(value);
+                goto raiseException;
+            }
+            POISE_VM_CASE(Unpack): {
+                {
                     auto value = pop();
                     if (value.object() == nullptr || value.object()->asIterable() == nullptr) {
-                        throw Exception(Exception::ExceptionType::InvalidType, fmt::format("{} cannot be unpacked", value.type()));
+                        POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("{} cannot be unpacked", value.type()));
                     }
                     value.object()->asIterable()->unpack(stack);
-                    break;
-                }
-                case Op::Assert: {
-                    const auto result = pop().toBool();
-                    const auto& message = constantList[constantIndex++];
-
-                    if (!result) {
-                        throw Exception(
-                            Exception::ExceptionType::AssertionFailed,
-                            message.toString()
-                        );
-                    }
-                    break;
                 }
-                case Op::TypeOf: {
-                    stack.emplace_back(typeValue(pop().type()));
-                    break;
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Assert): {
+                const auto result = pop().toBool();
+                const auto& message = constants[readOperand<u32>(ip)];
+
+                if (!result) {
+                    POISE_VM_RAISE(
+                        Exception::ExceptionType::AssertionFailed,
+                        message.toString()
+                    );
                 }
-                case Op::Print: {
-                    const auto numExpressions = constantList[constantIndex++].value<usize>();
-                    const auto err = constantList[constantIndex++].value<bool>();
-                    const auto newLine = constantList[constantIndex++].value<bool>();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(TypeOf): {
+                stack.emplace_back(typeValue(pop().type()));
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Print): {
+                {
+                    const auto numExpressions = static_cast<usize>(readOperand<u32>(ip));
+                    const auto err = readOperand<bool>(ip);
+                    const auto newLine = readOperand<bool>(ip);
                     const auto values = popCallArgs(numExpressions);
 
                     const auto stream = err ? stderr : stdout;
@@ -685,305 +1066,865 @@ auto Vm::run() const noexcept -> RunResult
                     if (newLine) {
                         fmt::print(stream, "\n");
                     }
-                    break;
                 }
-                case Op::LogicOr: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LogicOr): {
+                {
                     const auto [a, b] = popTwo();
                     stack.emplace_back(a || b);
-                    break;
                 }
-                case Op::LogicAnd: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LogicAnd): {
+                {
                     const auto [a, b] = popTwo();
                     stack.emplace_back(a && b);
-                    break;
                 }
-                case Op::BitwiseOr: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(BitwiseOr): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a | b);
-                    break;
+                    auto result = a.bitwiseOr(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::BitwiseXor: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(BitwiseXor): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a ^ b);
-                    break;
+                    auto result = a.bitwiseXor(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::BitwiseAnd: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(BitwiseAnd): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a & b);
-                    break;
+                    auto result = a.bitwiseAnd(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Equal: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Equal): {
+                {
                     const auto [a, b] = popTwo();
                     stack.emplace_back(a == b);
-                    break;
                 }
-                case Op::NotEqual: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(NotEqual): {
+                {
                     const auto [a, b] = popTwo();
                     stack.emplace_back(a != b);
-                    break;
                 }
-                case Op::LessThan: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessThan): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a < b);
-                    break;
+                    quicken(a, b, Op::LessThanIntInt, Op::LessThanFloatFloat);
+                    auto result = a.lessThan(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::LessEqual: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessEqual): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a <= b);
-                    break;
+                    quicken(a, b, Op::LessEqualIntInt, Op::LessEqualFloatFloat);
+                    auto result = a.lessEqual(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::GreaterThan: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterThan): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a > b);
-                    break;
+                    quicken(a, b, Op::GreaterThanIntInt, Op::GreaterThanFloatFloat);
+                    auto result = a.greaterThan(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::GreaterEqual: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterEqual): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a >= b);
-                    break;
+                    quicken(a, b, Op::GreaterEqualIntInt, Op::GreaterEqualFloatFloat);
+                    auto result = a.greaterEqual(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::LeftShift: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LeftShift): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a << b);
-                    break;
+                    auto result = a.leftShift(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::RightShift: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(RightShift): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a >> b);
-                    break;
+                    auto result = a.rightShift(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Addition: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Addition): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a + b);
-                    break;
+                    quicken(a, b, Op::AddIntInt, Op::AddFloatFloat);
+                    auto result = a.add(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Subtraction: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Subtraction): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a - b);
-                    break;
+                    quicken(a, b, Op::SubtractIntInt, Op::SubtractFloatFloat);
+                    auto result = a.subtract(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Multiply: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Multiply): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a * b);
-                    break;
+                    quicken(a, b, Op::MultiplyIntInt, Op::MultiplyFloatFloat);
+                    auto result = a.multiply(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Divide: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Divide): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a / b);
-                    break;
+                    auto result = a.divide(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Modulus: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Modulus): {
+                {
                     const auto [a, b] = popTwo();
-                    stack.emplace_back(a % b);
-                    break;
+                    auto result = a.modulus(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::LogicNot: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LogicNot): {
+                {
                     const auto value = pop();
                     stack.emplace_back(!value);
-                    break;
                 }
-                case Op::BitwiseNot: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(BitwiseNot): {
+                {
                     const auto value = pop();
-                    stack.emplace_back(~value);
-                    break;
+                    auto result = value.bitwiseNot();
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Negate: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Negate): {
+                {
                     const auto value = pop();
-                    stack.emplace_back(-value);
-                    break;
+                    auto result = value.negate();
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::Plus: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Plus): {
+                {
                     const auto value = pop();
-                    stack.emplace_back(+value);
-                    break;
-                }
-                case Op::MakeLambda: {
-                    const auto lambda = constantList[constantIndex++].object()->asFunction();
-                    stack.emplace_back(lambda->shallowClone());
-                    break;
+                    auto result = value.unaryPlus();
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::AssignIndex: {
-                    switch (auto [collection, index, value] = popThree(); collection.type()) {
-                        case types::Type::Dict: {
-                            collection.object()->asDictionary()->insertOrUpdate(std::move(index), std::move(value));
-                            break;
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(MakeLambda): {
+                const auto lambda = constants[readOperand<u32>(ip)].object()->asFunction();
+                stack.emplace_back(lambda->makeClosure());
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(AssignIndex): {
+                switch (auto [collection, index, value] = popThree(); collection.type()) {
+                    case types::Type::Dict: {
+                        collection.object()->asDictionary()->insertOrUpdate(std::move(index), std::move(value));
+                        break;
+                    }
+                    case types::Type::List: {
+                        if (index.type() != types::Type::Int) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::InvalidType,
+                                fmt::format("Expected Int to index List but got {}", index.type())
+                            );
                         }
-                        case types::Type::List: {
-                            if (index.type() != types::Type::Int) {
-                                throw Exception(
-                                    Exception::ExceptionType::InvalidType,
-                                    fmt::format("Expected Int to index List but got {}", index.type())
-                                );
-                            }
 
-                            collection.object()->asList()->at(index.value<isize>()) = std::move(value);
-                            break;
-                        }
-                        default: {
-                            throw Exception(
-                                Exception::ExceptionType::InvalidType,
-                                fmt::format("Cannot assign to {} at index", collection.type())
+                        const auto list = collection.object()->asList();
+                        const auto i = index.value<isize>();
+                        if (i < 0_i64 || i >= list->ssize()) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::IndexOutOfBounds,
+                                fmt::format("The index is {} but the size is {}", i, list->size())
                             );
                         }
+
+                        list->recordWrite(value);
+                        list->at(i) = std::move(value);
+                        break;
+                    }
+                    default: {
+                        POISE_VM_RAISE(
+                            Exception::ExceptionType::InvalidType,
+                            fmt::format("Cannot assign to {} at index", collection.type())
+                        );
                     }
-                    break;
                 }
-                case Op::LoadIndex: {
-                    switch (auto [collection, index] = popTwo(); collection.type()) {
-                        case types::Type::Dict: {
-                            stack.push_back(collection.object()->asDictionary()->at(index));
-                            break;
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadIndex): {
+                switch (auto [collection, index] = popTwo(); collection.type()) {
+                    case types::Type::Dict: {
+                        const auto value = collection.object()->asDictionary()->find(index);
+                        if (value == nullptr) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::KeyNotFound,
+                                fmt::format("{} was not present in the Dict", index)
+                            );
                         }
-                        case types::Type::List: {
-                            if (index.type() != types::Type::Int) {
-                                throw Exception(
-                                    Exception::ExceptionType::InvalidType,
-                                    fmt::format("Expected Int to index List but got {}", index.type())
-                                );
-                            }
 
-                            stack.push_back(collection.object()->asList()->at(index.value<isize>()));
-                            break;
+                        stack.push_back(*value);
+                        break;
+                    }
+                    case types::Type::List: {
+                        if (index.type() != types::Type::Int) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::InvalidType,
+                                fmt::format("Expected Int to index List but got {}", index.type())
+                            );
                         }
-                        case types::Type::String: {
-                            if (index.type() != types::Type::Int) {
-                                throw Exception(
-                                    Exception::ExceptionType::InvalidType,
-                                    fmt::format("Expected Int to index String but got {}", index.type())
-                                );
-                            }
 
-                            const auto& s = collection.string();
-                            const auto i = index.value<isize>();
-                            if (i < 0_i64 || i >= std::ssize(s)) {
-                                throw Exception(
-                                    Exception::ExceptionType::IndexOutOfBounds,
-                                    fmt::format("The index is {} but the size is {}", i, s.size())
-                                );
-                            }
+                        const auto list = collection.object()->asList();
+                        const auto i = index.value<isize>();
+                        if (i < 0_i64 || i >= list->ssize()) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::IndexOutOfBounds,
+                                fmt::format("The index is {} but the size is {}", i, list->size())
+                            );
+                        }
 
-                            std::string res;
-                            res.push_back(s[static_cast<usize>(i)]);
-                            stack.emplace_back(std::move(res));
-                            break;
+                        stack.push_back(list->at(i));
+                        break;
+                    }
+                    case types::Type::Range: {
+                        if (index.type() != types::Type::Int) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::InvalidType,
+                                fmt::format("Expected Int to index Range but got {}", index.type())
+                            );
                         }
-                        case types::Type::Tuple: {
-                            if (index.type() != types::Type::Int) {
-                                throw Exception(
-                                    Exception::ExceptionType::InvalidType,
-                                    fmt::format("Expected Int to index Tuple but got {}", index.type())
-                                );
-                            }
 
-                            stack.push_back(collection.object()->asTuple()->at(index.value<isize>()));
-                            break;
+                        const auto range = collection.object()->asRange();
+                        const auto i = index.value<isize>();
+                        if (i < 0_i64 || i >= range->ssize()) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::IndexOutOfBounds,
+                                fmt::format("The index is {} but the size is {}", i, range->size())
+                            );
                         }
-                        default: {
-                            throw Exception(
+
+                        stack.emplace_back(range->at(static_cast<usize>(i)));
+                        break;
+                    }
+                    case types::Type::String: {
+                        if (index.type() != types::Type::Int) {
+                            POISE_VM_RAISE(
                                 Exception::ExceptionType::InvalidType,
-                                fmt::format("Cannot index {}", collection.type())
+                                fmt::format("Expected Int to index String but got {}", index.type())
                             );
                         }
+
+                        const auto& s = collection.string();
+                        const auto i = index.value<isize>();
+                        if (i < 0_i64 || i >= std::ssize(s)) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::IndexOutOfBounds,
+                                fmt::format("The index is {} but the size is {}", i, s.size())
+                            );
+                        }
+
+                        std::string res;
+                        res.push_back(s[static_cast<usize>(i)]);
+                        stack.emplace_back(std::move(res));
+                        break;
+                    }
+                    case types::Type::Tuple: {
+                        if (index.type() != types::Type::Int) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::InvalidType,
+                                fmt::format("Expected Int to index Tuple but got {}", index.type())
+                            );
+                        }
+
+                        const auto tuple = collection.object()->asTuple();
+                        const auto i = index.value<isize>();
+                        if (i < 0_i64 || i >= tuple->ssize()) {
+                            POISE_VM_RAISE(
+                                Exception::ExceptionType::IndexOutOfBounds,
+                                fmt::format("The index was {} but the size is {}", i, tuple->size())
+                            );
+                        }
+
+                        stack.push_back(tuple->at(i));
+                        break;
+                    }
+                    default: {
+                        POISE_VM_RAISE(
+                            Exception::ExceptionType::InvalidType,
+                            fmt::format("Cannot index {}", collection.type())
+                        );
+                    }
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadLocalLoadConstant): {
+                const auto localIndex = readOperand<u32>(ip);
+                const auto constantIndex = readOperand<u32>(ip);
+                stack.push_back(stack[localIndex + localIndexOffset]);
+                stack.push_back(constants[constantIndex]);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LoadLocalLoadLocal): {
+                const auto firstLocalIndex = readOperand<u32>(ip);
+                const auto secondLocalIndex = readOperand<u32>(ip);
+                stack.push_back(stack[firstLocalIndex + localIndexOffset]);
+                stack.push_back(stack[secondLocalIndex + localIndexOffset]);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessThanJumpIfFalse): {
+                {
+                    const auto [a, b] = popTwo();
+                    const auto jumpTarget = readOperand<u32>(ip);
+                    const auto popValue = readOperand<bool>(ip);
+                    auto result = a.lessThan(b);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    if (!*result) {
+                        ip = code + jumpTarget;
+                    }
+
+                    if (!popValue) {
+                        stack.emplace_back(*result);
+                    }
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(AddRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.add(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(SubtractRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.subtract(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(MultiplyRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.multiply(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(DivideRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.divide(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(ModulusRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.modulus(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(EqualRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    writeRegister(Value{lhs == rhs});
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(NotEqualRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    writeRegister(Value{lhs != rhs});
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessThanRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.lessThan(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessEqualRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.lessEqual(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterThanRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.greaterThan(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterEqualRegisters): {
+                {
+                    const auto [lhs, rhs] = readRegisters();
+                    auto result = lhs.greaterEqual(rhs);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
                     }
-                    break;
+
+                    writeRegister(std::move(*result));
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(AddIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() + b.value<i64>());
+                } else {
+                    rewriteOp(Op::Addition);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(AddFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() + b.value<f64>());
+                } else {
+                    rewriteOp(Op::Addition);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(SubtractIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() - b.value<i64>());
+                } else {
+                    rewriteOp(Op::Subtraction);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(SubtractFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() - b.value<f64>());
+                } else {
+                    rewriteOp(Op::Subtraction);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(MultiplyIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() * b.value<i64>());
+                } else {
+                    rewriteOp(Op::Multiply);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(MultiplyFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() * b.value<f64>());
+                } else {
+                    rewriteOp(Op::Multiply);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessThanIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() < b.value<i64>());
+                } else {
+                    rewriteOp(Op::LessThan);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessThanFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() < b.value<f64>());
+                } else {
+                    rewriteOp(Op::LessThan);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessEqualIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() <= b.value<i64>());
+                } else {
+                    rewriteOp(Op::LessEqual);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(LessEqualFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() <= b.value<f64>());
+                } else {
+                    rewriteOp(Op::LessEqual);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterThanIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() > b.value<i64>());
+                } else {
+                    rewriteOp(Op::GreaterThan);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterThanFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() > b.value<f64>());
+                } else {
+                    rewriteOp(Op::GreaterThan);
+                    ip = opStart;
                 }
-                case Op::Call: {
-                    auto numArgs = constantList[constantIndex++].value<usize>();
-                    const auto hasUnpack = constantList[constantIndex++].value<bool>();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterEqualIntInt): {
+                if (const auto [a, b] = peekTwo(); a.isInt() && b.isInt()) {
+                    replaceTopTwo(a.value<i64>() >= b.value<i64>());
+                } else {
+                    rewriteOp(Op::GreaterEqual);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(GreaterEqualFloatFloat): {
+                if (const auto [a, b] = peekTwo(); a.isFloat() && b.isFloat()) {
+                    replaceTopTwo(a.value<f64>() >= b.value<f64>());
+                } else {
+                    rewriteOp(Op::GreaterEqual);
+                    ip = opStart;
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Call):
+            POISE_VM_CASE(TailCall): {
+                {
+                    gcSafepoint();
+
+                    const auto isTailCall = static_cast<Op>(*opStart) == Op::TailCall;
+                    auto numArgs = static_cast<usize>(readOperand<u8>(ip));
+                    const auto hasUnpack = readOperand<bool>(ip);
+                    const auto isDotCall = readOperand<bool>(ip);
 
                     if (hasUnpack) {
                         numArgs += pop().value<usize>() - 1_uz; // -1 for the pack, replace it with the size of the pack
                     }
 
-                    auto args = popCallArgs(numArgs);   // not const so we can move into local vars if needed
-
-                    const auto isDotCall = constantList[constantIndex++].value<bool>();
+                    // for a dot call the object the function was called on is the first arg
                     if (isDotCall) {
-                        args.insert(args.begin(), pop());
+                        numArgs++;
                     }
 
-                    const auto function = pop();
+                    // the args stay where they are on the stack and become the callee's first locals
+                    const auto argsStart = stack.size() - numArgs;
+                    const auto function = stack[argsStart - 1_uz];
 
                     if (auto object = function.object()) {
                         if (auto calleeFunction = object->asFunction()) {
-                            const auto hasVariadicParams = calleeFunction->hasVariadicParams();
-
-                            // if the function has a pack, numParams can be >= arity
-                            numArgs = isDotCall ? numArgs + 1_u8 : numArgs;
-                            if (hasVariadicParams) {
-                                if (numArgs < calleeFunction->arity()) {
-                                    throw Exception(
-                                        Exception::ExceptionType::IncorrectArgCount,
-                                        fmt::format("Function '{}' takes >={} args but was given {}", calleeFunction->name(), calleeFunction->arity(), numArgs)
-                                    );
-                                }
-                            } else {
-                                if (numArgs != calleeFunction->arity()) {
-                                    throw Exception(
-                                        Exception::ExceptionType::IncorrectArgCount,
-                                        fmt::format("Function '{}' takes {} args but was given {}", calleeFunction->name(), calleeFunction->arity(), numArgs)
-                                    );
-                                }
+                            if (auto error = arityError(calleeFunction, numArgs)) {
+                                POISE_VM_RAISE_ERROR(*error);
                             }
 
-                            callStack.push_back({
-                                .localIndexOffset = localVariables.size(),
-                                .opIndex = 0_uz,
-                                .constantIndex = 0_uz,
-                                .heldIteratorsSize = heldIterators.size(),
-                                .callSiteLine = line,
-                                .callerFunction = currentFunction,
-                                .calleeFunction = calleeFunction,
-                            });
-
-                            if (hasVariadicParams) {
-                                std::vector<Value> variadicParams;
-                                for (auto i = calleeFunction->arity() - 1_uz; i < numArgs; i++) {
-                                    variadicParams.emplace_back(std::move(args[i]));
-                                }
-                                args.resize(args.size() - variadicParams.size());
-                                args.emplace_back(Value::createObject<List>(std::move(variadicParams)));
+                            if (isTailCall) {
+                                replaceFrame(calleeFunction, numArgs, true);
+                            } else {
+                                pushFrame(calleeFunction, numArgs, true);
                             }
-
-                            localVariables.insert(localVariables.end(), std::make_move_iterator(args.begin()), std::make_move_iterator(args.end()));
                         } else if (auto type = object->asType()) {
-                            stack.emplace_back(type->construct(args));
+                            auto result = type->construct(std::span{stack.data() + argsStart, numArgs});
+                            if (!result) {
+                                POISE_VM_RAISE_ERROR(result.error());
+                            }
+
+                            // replace the type and its args with the constructed value
+                            stack.resize(argsStart - 1_uz);
+                            stack.emplace_back(std::move(*result));
                         } else {
-                            throw Exception(Exception::ExceptionType::InvalidType, fmt::format("{} is not callable", function));
+                            POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("{} is not callable", function));
                         }
                     } else {
-                        throw Exception(Exception::ExceptionType::InvalidType, fmt::format("{} is not callable", function.type()));
+                        POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("{} is not callable", function.type()));
+                    }
+                }
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(CallDirect):
+            POISE_VM_CASE(TailCallDirect): {
+                gcSafepoint();
+
+                const auto isTailCall = static_cast<Op>(*opStart) == Op::TailCallDirect;
+                auto numArgs = static_cast<usize>(readOperand<u8>(ip));
+                const auto hasUnpack = readOperand<bool>(ip);
+                const auto argsChecked = readOperand<bool>(ip);
+                const auto calleeFunction = std::bit_cast<Function*>(readOperand<usize>(ip));
+
+                // the link pass has checked the number of args unless there was an unpack or they didn't match
+                if (!argsChecked) {
+                    if (hasUnpack) {
+                        numArgs += pop().value<usize>() - 1_uz; // -1 for the pack, replace it with the size of the pack
                     }
 
-                    break;
+                    if (auto error = arityError(calleeFunction, numArgs)) {
+                        POISE_VM_RAISE_ERROR(*error);
+                    }
                 }
-                case Op::CallNative: {
-                    const auto hash = constantList[constantIndex++].value<NativeNameHash>();
-                    const auto function = m_nativeFunctionLookup.at(hash);
-                    const auto arity = function.arity();
-                    auto args = popCallArgs(arity); // number of call args is checked at compile time
-                    stack.emplace_back(function(args));
-                    break;
+
+                // unlike Call the callee is not on the stack
+                if (isTailCall) {
+                    replaceFrame(calleeFunction, numArgs, false);
+                } else {
+                    pushFrame(calleeFunction, numArgs, false);
                 }
-                case Op::Exit: {
-                    POISE_ASSERT(stack.empty(), "Stack not empty after runtime, there has been an error in codegen");
-                    POISE_ASSERT(localVariables.empty(), "Locals have not been popped, there has been an error in codegen");
-                    POISE_ASSERT(heldIterators.empty(), "Held iterators not empty, there has been an error in codegen");
-                    POISE_ASSERT(tryBlockStateStack.empty(), "Try block state stack not empty, there has been an error in codegen");
-                    POISE_ASSERT(callStack.size() == 1_uz, "Call stack not empty, there has been an error in codegen");
 
-                    markGcRoots();
-                    memory::Gc::instance().finalise();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(CallNative): {
+                {
+                    const auto index = readOperand<NativeIndex>(ip);
+                    const auto& function = m_nativeFunctions[index];
+                    // number of call args is checked at compile time, natives don't call back into the vm
+                    // so the args can be passed in place and popped afterwards
+                    const auto argsStart = stack.size() - function.arity();
+                    auto result = function(std::span{stack}.subspan(argsStart));
+                    stack.resize(argsStart);
+                    if (!result) {
+                        POISE_VM_RAISE_ERROR(result.error());
+                    }
 
-                    return RunResult::Success;
+                    stack.emplace_back(std::move(*result));
                 }
-                case Op::InitIterator: {
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Exit): {
+                POISE_ASSERT(stack.empty(), "Stack not empty after runtime, there has been an error in codegen");
+                POISE_ASSERT(heldIterators.empty(), "Held iterators not empty, there has been an error in codegen");
+                POISE_ASSERT(tryBlockStateStack.empty(), "Try block state stack not empty, there has been an error in codegen");
+                POISE_ASSERT(callStack.size() == 1_uz, "Call stack not empty, there has been an error in codegen");
+
+                markGcRoots();
+                memory::Gc::instance().finalise();
+
+                return RunResult::Success;
+            }
+            POISE_VM_CASE(ForRangeInit): {
+                const auto firstIteratorLocalIndex = readOperand<u32>(ip);
+                const auto inclusive = readOperand<bool>(ip);
+                const auto exitJumpTarget = readOperand<u32>(ip);
+
+                // the loop's iterator is followed by the range's start, end, and increment
+                const auto iteratorSlot = firstIteratorLocalIndex + localIndexOffset;
+                const auto& start = stack[iteratorSlot + 1_uz];
+                const auto& end = stack[iteratorSlot + 2_uz];
+                const auto& increment = stack[iteratorSlot + 3_uz];
+
+                if (!start.isInt()) {
+                    POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("Expected Int for range start but got {}", start.type()));
+                }
+                if (!end.isInt()) {
+                    POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("Expected Int for range end but got {}", end.type()));
+                }
+                if (!increment.isInt()) {
+                    POISE_VM_RAISE(Exception::ExceptionType::InvalidType, fmt::format("Expected Int for range increment but got {}", increment.type()));
+                }
+
+                const auto startValue = start.value<i64>();
+                const auto endValue = end.value<i64>();
+                const auto incrementValue = increment.value<i64>();
+
+                // same as Range, no iteration if the increment is 0 or goes the other direction of start -> end
+                if (!((startValue < endValue && incrementValue > 0_i64) || (endValue < startValue && incrementValue < 0_i64))) {
+                    ip = code + exitJumpTarget;
+                    POISE_VM_DISPATCH();
+                }
+
+                // the number of steps after the first iteration replaces the end,
+                // so stepping never has to compare against the end and can't overflow past it
+                const auto last = inclusive ? endValue : (incrementValue > 0_i64 ? endValue - 1_i64 : endValue + 1_i64);
+                const auto distance = incrementValue > 0_i64
+                    ? static_cast<u64>(last) - static_cast<u64>(startValue)
+                    : static_cast<u64>(startValue) - static_cast<u64>(last);
+                const auto magnitude = incrementValue > 0_i64 ? static_cast<u64>(incrementValue) : 0_u64 - static_cast<u64>(incrementValue);
+
+                stack[iteratorSlot] = startValue;
+                stack[iteratorSlot + 2_uz] = static_cast<i64>(distance / magnitude);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(ForRangeStep): {
+                const auto iteratorSlot = readOperand<u32>(ip) + localIndexOffset;
+                const auto loopStart = readOperand<u32>(ip);
+
+                auto& remainingSteps = stack[iteratorSlot + 2_uz];
+                if (remainingSteps.value<i64>() != 0_i64) {
+                    // same as IncrementIterator, lambdas capturing the iterator keep the value from their iteration
+                    closeUpvalues(iteratorSlot);
+
+                    remainingSteps = static_cast<i64>(static_cast<u64>(remainingSteps.value<i64>()) - 1_u64);
+                    auto& counter = stack[iteratorSlot + 1_uz];
+                    counter = static_cast<i64>(static_cast<u64>(counter.value<i64>()) + static_cast<u64>(stack[iteratorSlot + 3_uz].value<i64>()));
+                    stack[iteratorSlot] = counter;
+
+                    // this is the loop's backwards jump, so it's a safepoint like Jump
+                    gcSafepoint();
+                    ip = code + loopStart;
+                }
+
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(InitIterator): {
+                {
                     auto value = pop();
                     if (value.object() == nullptr || !value.object()->iterable()) {
-                        throw Exception{
+                        POISE_VM_RAISE(
                             Exception::ExceptionType::InvalidType,
                             fmt::format("{} is not iterable", value.type())
-                        };
+                        );
                     }
 
                     heldIterators.push_back(Value::createObject<Iterator>(value));
@@ -991,12 +1932,12 @@ auto Vm::run() const noexcept -> RunResult
                     const auto isAtEnd = iteratorPtr->isAtEnd();
                     stack.emplace_back(iteratorPtr->isAtEnd());
 
-                    const auto firstIteratorLocalIndex = constantList[constantIndex++].value<usize>();
-                    const auto secondIteratorLocalIndex = constantList[constantIndex++].value<usize>();
-                    auto& firstLocal = localVariables[firstIteratorLocalIndex + localIndexOffset];
+                    const auto firstIteratorLocalIndex = readOperand<u32>(ip);
+                    const auto secondIteratorLocalIndex = readOperand<u32>(ip);
+                    auto& firstLocal = stack[firstIteratorLocalIndex + localIndexOffset];
                     // this might not actually be an iterator if we're not using two iterators,
                     // but it will definitely exist and just not be used if we only have one iterator
-                    auto& secondLocal = localVariables[secondIteratorLocalIndex + localIndexOffset];
+                    auto& secondLocal = stack[secondIteratorLocalIndex + localIndexOffset];
 
                     switch (value.type()) {
                         case types::Type::List: {
@@ -1014,9 +1955,8 @@ auto Vm::run() const noexcept -> RunResult
                                 }
                             } else {
                                 if (secondIteratorLocalIndex > 0_uz) {
-                                    const auto pair = iteratorPtr->value().object()->asTuple();
-                                    firstLocal = pair->at(0_uz);
-                                    secondLocal = pair->at(1_uz);
+                                    firstLocal = iteratorPtr->dictKey();
+                                    secondLocal = iteratorPtr->dictValue();
                                 } else {
                                     firstLocal = iteratorPtr->value();
                                 }
@@ -1028,10 +1968,10 @@ auto Vm::run() const noexcept -> RunResult
                         case types::Type::Tuple: {
                             firstLocal = isAtEnd ? Value::none() : iteratorPtr->value();
                             if (secondIteratorLocalIndex > 0_uz) {
-                                throw Exception{
+                                POISE_VM_RAISE(
                                     Exception::ExceptionType::InvalidType,
                                     fmt::format("{} cannot have two iterators", value.type())
-                                };
+                                );
                             }
                             break;
                         }
@@ -1039,156 +1979,132 @@ auto Vm::run() const noexcept -> RunResult
                             POISE_UNREACHABLE();
                             break;
                     }
-
-                    break;
                 }
-                case Op::IncrementIterator: {
-                    auto iterator = heldIterators.back().object()->asIterator();
-                    iterator->increment();
-                    const auto isAtEnd = iterator->isAtEnd();
-                    stack.emplace_back(isAtEnd);
-
-                    const auto firstIteratorLocalIndex = constantList[constantIndex++].value<usize>();
-                    const auto secondIteratorLocalIndex = constantList[constantIndex++].value<usize>();
-                    auto& firstLocal = localVariables[firstIteratorLocalIndex + localIndexOffset];
-                    // this might not actually be an iterator if we're not using two iterators,
-                    // but it will definitely exist and just not be used if we only have one iterator
-                    auto& secondLocal = localVariables[secondIteratorLocalIndex + localIndexOffset];
-
-                    switch (iterator->iterableValue().type()) {
-                        case types::Type::List: {
-                            firstLocal = isAtEnd ? Value::none() : iterator->value();
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(IncrementIterator): {
+                const auto firstIteratorLocalIndex = readOperand<u32>(ip);
+                const auto secondIteratorLocalIndex = readOperand<u32>(ip);
+                // the iterators are declared once for the whole loop, but lambdas capturing them
+                // should see the value from the iteration they were made in
+                closeUpvalues(firstIteratorLocalIndex + localIndexOffset);
+
+                auto iterator = heldIterators.back().object()->asIterator();
+                iterator->increment();
+                const auto isAtEnd = iterator->isAtEnd();
+                stack.emplace_back(isAtEnd);
+
+                auto& firstLocal = stack[firstIteratorLocalIndex + localIndexOffset];
+                // this might not actually be an iterator if we're not using two iterators,
+                // but it will definitely exist and just not be used if we only have one iterator
+                auto& secondLocal = stack[secondIteratorLocalIndex + localIndexOffset];
+
+                switch (iterator->iterableValue().type()) {
+                    case types::Type::List: {
+                        firstLocal = isAtEnd ? Value::none() : iterator->value();
+                        if (secondIteratorLocalIndex > 0_uz) {
+                            secondLocal = secondLocal.value<i64>() + 1_i64;
+                        }
+                        break;
+                    }
+                    case types::Type::Dict: {
+                        if (isAtEnd) {
+                            firstLocal = Value::none();
                             if (secondIteratorLocalIndex > 0_uz) {
-                                secondLocal = secondLocal.value<i64>() + 1_i64;
+                                secondLocal = Value::none();
                             }
-                            break;
-                        }
-                        case types::Type::Dict: {
-                            if (isAtEnd) {
-                                firstLocal = Value::none();
-                                if (secondIteratorLocalIndex > 0_uz) {
-                                    secondLocal = Value::none();
-                                }
+                        } else {
+                            if (secondIteratorLocalIndex > 0_uz) {
+                                firstLocal = iterator->dictKey();
+                                secondLocal = iterator->dictValue();
                             } else {
-                                if (secondIteratorLocalIndex > 0_uz) {
-                                    const auto pair = iterator->value().object()->asTuple();
-                                    firstLocal = pair->at(0_uz);
-                                    secondLocal = pair->at(1_uz);
-                                } else {
-                                    firstLocal = iterator->value();
-                                }
+                                firstLocal = iterator->value();
                             }
-                            break;
                         }
-                        case types::Type::Range:
-                        case types::Type::Set:
-                        case types::Type::Tuple: {
-                            firstLocal = isAtEnd ? Value::none() : iterator->value();
-                            break;
-                        }
-                        default:
-                            POISE_UNREACHABLE();
-                            break;
+                        break;
                     }
-
-                    if (isAtEnd) {
-                        heldIterators.pop_back();
+                    case types::Type::Range:
+                    case types::Type::Set:
+                    case types::Type::Tuple: {
+                        firstLocal = isAtEnd ? Value::none() : iterator->value();
+                        break;
                     }
-
-                    break;
+                    default:
+                        POISE_UNREACHABLE();
+                        break;
                 }
-                case Op::Jump: {
-                    const auto jumpConstantIndex = constantList[constantIndex++].value<usize>();
-                    const auto jumpOpIndex = constantList[constantIndex++].value<usize>();
-                    callStackTop.constantIndex = jumpConstantIndex;
-                    callStackTop.opIndex = jumpOpIndex;
-                    break;
+
+                if (isAtEnd) {
+                    heldIterators.pop_back();
                 }
-                case Op::JumpIfFalse: {
-                    POISE_ASSERT(!stack.empty(), "Stack should not be empty, there has been an error in codegen");
 
-                    const auto& value = stack.back();
-                    const auto& jumpConstantIndex = constantList[constantIndex++];
-                    const auto& jumpOpIndex = constantList[constantIndex++];
-                    const auto& popValue = constantList[constantIndex++];
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Jump): {
+                // loops jump backwards with this, so it doubles as a safepoint to collect cycles
+                gcSafepoint();
+                ip = code + readOperand<u32>(ip);
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(JumpIfFalse): {
+                POISE_ASSERT(!stack.empty(), "Stack should not be empty, there has been an error in codegen");
 
-                    if (!value.toBool()) {
-                        callStackTop.constantIndex = jumpConstantIndex.value<usize>();
-                        callStackTop.opIndex = jumpOpIndex.value<usize>();
-                    }
+                const auto& value = stack.back();
+                const auto jumpTarget = readOperand<u32>(ip);
+                const auto popValue = readOperand<bool>(ip);
 
-                    if (popValue.toBool()) {
-                        pop();
-                    }
+                if (!value.toBool()) {
+                    ip = code + jumpTarget;
+                }
 
-                    break;
+                if (popValue) {
+                    pop();
                 }
-                case Op::JumpIfTrue: {
-                    POISE_ASSERT(!stack.empty(), "Stack should not be empty, there has been an error in codegen");
 
-                    const auto& value = stack.back();
-                    const auto& jumpConstantIndex = constantList[constantIndex++];
-                    const auto& jumpOpIndex = constantList[constantIndex++];
-                    const auto& popIfJump = constantList[constantIndex++];
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(JumpIfTrue): {
+                POISE_ASSERT(!stack.empty(), "Stack should not be empty, there has been an error in codegen");
 
-                    if (value.toBool()) {
-                        callStackTop.constantIndex = jumpConstantIndex.value<usize>();
-                        callStackTop.opIndex = jumpOpIndex.value<usize>();
-                    }
-                    
-                    if (popIfJump.toBool()) {
-                        pop();
-                    }
+                const auto& value = stack.back();
+                const auto jumpTarget = readOperand<u32>(ip);
+                const auto popIfJump = readOperand<bool>(ip);
 
-                    break;
+                if (value.toBool()) {
+                    ip = code + jumpTarget;
                 }
-                case Op::Return: {
+
+                if (popIfJump) {
+                    pop();
+                }
+
+                POISE_VM_DISPATCH();
+            }
+            POISE_VM_CASE(Return): {
+                {
                     printMemory();
                     while (heldIterators.size() != callStack.back().heldIteratorsSize) {
                         heldIterators.pop_back();
                     }
+                    // drop the frame's locals and the callee, leaving the return value in their place
+                    auto result = pop();
+                    closeUpvalues(callStack.back().returnStackSize);
+                    stack.resize(callStack.back().returnStackSize);
+                    stack.push_back(std::move(result));
                     callStack.pop_back();
-                    break;
+                    loadFrame();
                 }
+                POISE_VM_DISPATCH();
             }
-        } catch (const Exception& exception) {
-            const auto inTryBlock = !tryBlockStateStack.empty();
+            POISE_VM_LOOP_END()
 
-            if (inTryBlock) {
-                const auto [stackSize, callStackSize, constantIndexToJumpTo, opIndexToJumpTo, heldIteratorsSize] = tryBlockStateStack.top();
-
-                callStack.resize(callStackSize);
-                callStack.back().constantIndex = constantIndexToJumpTo;
-                callStack.back().opIndex = opIndexToJumpTo;
-
-                while (heldIterators.size() != heldIteratorsSize) {
-                    heldIterators.pop_back();
-                }
-
-                tryBlockStateStack.pop();
-
-                stack.resize(stackSize);
-                stack.push_back(Value::createObject<Exception>(exception.exceptionType(), std::string{exception.message()}));
-            } else {
-                print(stderr, fmt::emphasis::bold | fg(fmt::color::red), "Runtime Error: ");
-                fmt::print(stderr, "{}\n", exception.toString());
-
-                if (currentFunction != nullptr) {
-                    fmt::print(stderr, "  At {}:{} in function '{}'\n", currentFunction->filePath().string(), line, currentFunction->name());
-                    fmt::print(stderr, "    {}\n", scanner::Scanner::getCodeAtLine(currentFunction->filePath(), line));
-                } else  {
-                    fmt::print(stderr, "  At entry\n");
-                }
-
-                for (const auto& entry : callStack | std::views::reverse) {
-                    if (const auto caller = entry.callerFunction) {
-                        fmt::print(stderr, "  At {}:{} in function '{}'\n", caller->filePath().string(), entry.callSiteLine, caller->name());
-                        fmt::print(stderr, "    {}\n", scanner::Scanner::getCodeAtLine(caller->filePath(), entry.callSiteLine));
-                    }
-                }
-
-                fmt::print(stderr, "\nThis is an exception thrown by the runtime as a result of a problem in your poise code that has not been caught.\n");
-                fmt::print(stderr, "Consider reviewing your code or catching this exception with a `try/catch` statement.\n");
+        raiseException:
+            if (!catchRaisedException()) {
+                return RunResult::RuntimeError;
+            }
+        } catch (const Exception& exception) {
+            raisedException = Value::createObject<Exception>(exception.exceptionType(), std::string{exception.message()});
+            if (!catchRaisedException()) {
                 return RunResult::RuntimeError;
             }
         }/* catch (const std::exception& exception) {
@@ -1198,6 +2114,14 @@ auto Vm::run() const noexcept -> RunResult
             return RunResult::RuntimeError;
         }*/
     }
-#undef PRINT_MEMORY
+#undef POISE_VM_CASE
+#undef POISE_VM_DISPATCH
+#undef POISE_VM_LOOP_BEGIN
+#undef POISE_VM_LOOP_END
+#undef POISE_VM_RAISE
+#undef POISE_VM_RAISE_ERROR
+#ifdef POISE_GCC_CLANG
+#pragma GCC diagnostic pop
+#endif
 }
 }   // namespace poise::runtime
@@ -4,12 +4,15 @@
 #include "../Poise.hpp"
 
 #include "../objects/Function.hpp"
+#include "Chunk.hpp"
 #include "Op.hpp"
 #include "NamespaceManager.hpp"
 #include "NativeFunction.hpp"
 #include "Types.hpp"
 #include "Value.hpp"
 
+#include <filesystem>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -25,27 +28,55 @@ public:
     };
 
     using NativeNameHash = usize;
-    using NativeFunctionMap = std::unordered_map<NativeNameHash, NativeFunction>;
+    using NativeIndex = u32;
+
+    // a function or struct referenced by name, resolved by the link pass once every namespace has been compiled
+    struct LinkSite
+    {
+        enum class Kind
+        {
+            Call,   // a CallDirect, its function operand is filled in
+            Load,   // a LoadDirect, its object operand is filled in
+        };
+
+        Kind kind;
+        Chunk* chunk;
+        usize index;    // the offset of the CallDirect or LoadDirect
+        usize namespaceHash;
+        usize nameHash;
+        usize callerNamespaceHash;
+        std::filesystem::path callerFilePath;
+        usize line;
+    };
 
     explicit Vm(std::string mainFilePath);
 
     auto setCurrentFunction(objects::Function* function) noexcept -> void;
     [[nodiscard]] auto currentFunction() const noexcept -> objects::Function*;
 
-    [[nodiscard]] auto nativeFunctionHash(std::string_view functionName) const noexcept -> std::optional<NativeNameHash>;
-    [[nodiscard]] auto nativeFunctionArity(NativeNameHash hash) const noexcept -> u8;
+    // natives are only looked up by name at compile time, the vm calls them by their index
+    [[nodiscard]] auto nativeFunctionIndex(std::string_view functionName) const noexcept -> std::optional<NativeIndex>;
+    [[nodiscard]] auto nativeFunctionArity(NativeIndex index) const noexcept -> u8;
 
     [[nodiscard]] auto namespaceManager() const noexcept -> const NamespaceManager*;
     [[nodiscard]] auto namespaceManager() noexcept -> NamespaceManager*;
     [[nodiscard]] auto typeValue(types::Type type) const noexcept -> const Value&;
 
-    auto emitOp(Op op, usize line) noexcept -> void;
-    auto emitConstant(Value value) noexcept -> void;
+    // the chunk of the function currently being compiled, or the entry chunk if at top level
+    [[nodiscard]] auto currentChunk() noexcept -> Chunk*;
+
+    // whether the compiler should emit three-address ops operating directly on locals and constants
+    auto setRegisterOps(bool registerOps) noexcept -> void;
+    [[nodiscard]] auto registerOps() const noexcept -> bool;
 
-    [[nodiscard]] auto run() const noexcept -> RunResult;
+    auto addLinkSite(LinkSite linkSite) noexcept -> void;
+    [[nodiscard]] auto linkSites() const noexcept -> std::span<const LinkSite>;
+
+    [[nodiscard]] auto run() noexcept -> RunResult;
 
 private:
     auto registerNatives() noexcept -> void;
+    auto registerNative(std::string_view functionName, NativeFunction function) noexcept -> void;
 
     auto registerDictNatives() noexcept -> void;
     auto registerFloatNatives() noexcept -> void;
@@ -57,15 +88,19 @@ private:
     auto registerStringNatives() noexcept -> void;
 
     std::hash<std::string_view> m_nativeNameHasher;
-    NativeFunctionMap m_nativeFunctionLookup;
+    std::unordered_map<NativeNameHash, NativeIndex> m_nativeFunctionLookup;
+    std::vector<NativeFunction> m_nativeFunctions;
 
     std::string m_mainFilePath;
 
-    std::vector<OpLine> m_globalOps;
-    std::vector<Value> m_globalConstants;
+    Chunk m_globalChunk;
 
     objects::Function* m_currentFunction{nullptr};
 
+    bool m_registerOps{false};
+
+    std::vector<LinkSite> m_linkSites;
+
     NamespaceManager m_namespaceManager;
     
     std::unordered_map<types::Type, runtime::Value> m_typeLookup;
@@ -14,26 +14,33 @@
 namespace poise::runtime {
 using objects::Exception;
 
-static auto throwIfWrongType(usize position, const Value& value, types::Type type) -> void
+static auto wrongTypeError(usize position, const Value& value, types::Type type) -> std::optional<Error>
 {
     if (value.type() != type) {
-        throw Exception(Exception::ExceptionType::InvalidType, fmt::format("Expected {} at position {} but got {}", type, position, value.type()));
+        return Error{Exception::ExceptionType::InvalidType, fmt::format("Expected {} at position {} but got {}", type, position, value.type())};
     }
+
+    return std::nullopt;
 }
 
-static auto throwIfWrongType(usize position, const Value& value, std::initializer_list<types::Type> types) -> void
+static auto wrongTypeError(usize position, const Value& value, std::initializer_list<types::Type> types) -> std::optional<Error>
 {
     if (std::ranges::none_of(types, [&value] (types::Type type) -> bool {
         return value.type() == type;
     })) {
-        throw Exception(Exception::ExceptionType::InvalidType, fmt::format("Expected {} at position {} but got {}", fmt::join(types, " or "), position, value.type()));
+        return Error{Exception::ExceptionType::InvalidType, fmt::format("Expected {} at position {} but got {}", fmt::join(types, " or "), position, value.type())};
     }
+
+    return std::nullopt;
 }
 
-static auto throwIfNotIterable(usize position, const Value& value) -> void {
+static auto notIterableError(usize position, const Value& value) -> std::optional<Error>
+{
     if (value.object() == nullptr || value.object()->asIterable() == nullptr) {
-        throw Exception(Exception::ExceptionType::InvalidType, fmt::format("Expected iterable at position {} but got {}", position, value.type()));
+        return Error{Exception::ExceptionType::InvalidType, fmt::format("Expected iterable at position {} but got {}", position, value.type())};
     }
+
+    return std::nullopt;
 }
 
 auto Vm::registerNatives() noexcept -> void
@@ -48,40 +55,62 @@ auto Vm::registerNatives() noexcept -> void
     registerStringNatives();
 }   // Vm::registerNatives()
 
+auto Vm::registerNative(std::string_view functionName, NativeFunction function) noexcept -> void
+{
+    m_nativeFunctionLookup.emplace(m_nativeNameHasher(functionName), static_cast<NativeIndex>(m_nativeFunctions.size()));
+    m_nativeFunctions.push_back(function);
+}
+
 auto Vm::registerDictNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_DICT_CONTAINS_KEY"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Dict);
+    registerNative("__NATIVE_DICT_CONTAINS_KEY", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Dict)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asDictionary()->containsKey(args[1_uz]);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_DICT_TRY_INSERT"), NativeFunction{
-        3_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Dict);
+    registerNative("__NATIVE_DICT_TRY_INSERT", NativeFunction{
+        3_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Dict)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asDictionary()->tryInsert(std::move(args[1_uz]), std::move(args[2_uz]));
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_DICT_INSERT"), NativeFunction{
-        3_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Dict);
+    registerNative("__NATIVE_DICT_INSERT", NativeFunction{
+        3_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Dict)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             args[0_uz].object()->asDictionary()->insertOrUpdate(std::move(args[1_uz]), std::move(args[2_uz]));
             return Value::none();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_DICT_REMOVE"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Dict);
+    registerNative("__NATIVE_DICT_REMOVE", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Dict)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asDictionary()->remove(args[1_uz]);
         }});
 }
 
 auto Vm::registerFloatNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_FLOAT_POW"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Float);
-            throwIfWrongType(1_uz, args[1_uz], {types::Type::Float, types::Type::Int});
+    registerNative("__NATIVE_FLOAT_POW", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Float)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], {types::Type::Float, types::Type::Int})) {
+                return std::unexpected{std::move(*typeError)};
+            }
 
             return std::pow(
                 args[0_uz].value<f64>(),
@@ -89,37 +118,54 @@ auto Vm::registerFloatNatives() noexcept -> void
             );
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_FLOAT_SQRT"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Float);
+    registerNative("__NATIVE_FLOAT_SQRT", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Float)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return std::sqrt(args[0_uz].value<f64>());
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_FLOAT_ABS"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Float);
+    registerNative("__NATIVE_FLOAT_ABS", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Float)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return std::abs(args[0_uz].value<f64>());
         }});
 }
 
 auto Vm::registerIntNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_INT_POW"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Int);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Int);
+    registerNative("__NATIVE_INT_POW", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return static_cast<i64>(std::pow(args[0_uz].value<i64>(), args[1_uz].value<i64>()));
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_INT_SQRT"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Int);
+    registerNative("__NATIVE_INT_SQRT", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return static_cast<i64>(std::sqrt(args[0_uz].value<i64>()));
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_INT_ABS"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Int);
+    registerNative("__NATIVE_INT_ABS", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return std::abs(args[0_uz].value<i64>());
         }});
 }
@@ -127,145 +173,222 @@ auto Vm::registerIntNatives() noexcept -> void
 
 auto Vm::registerIterableNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_ITERABLE_SIZE"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfNotIterable(0_uz, args[0_uz]);
+    registerNative("__NATIVE_ITERABLE_SIZE", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = notIterableError(0_uz, args[0_uz])) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asIterable()->size();
         }});
 }
 
 auto Vm::registerListNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_EMPTY"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
+    registerNative("__NATIVE_LIST_EMPTY", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->empty();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_APPEND"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
+    registerNative("__NATIVE_LIST_APPEND", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             args[0_uz].object()->asList()->append(std::move(args[1_uz]));
             return Value::none();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_INSERT"), NativeFunction{
-        3_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Int);
+    registerNative("__NATIVE_LIST_INSERT", NativeFunction{
+        3_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->insert(args[1_uz].value<usize>(), std::move(args[2_uz]));
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_REMOVE"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
+    registerNative("__NATIVE_LIST_REMOVE", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->remove(args[1_uz]);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_REMOVE_FIRST"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
+    registerNative("__NATIVE_LIST_REMOVE_FIRST", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->removeFirst(args[1_uz]);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_REMOVE_AT"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Int);
+    registerNative("__NATIVE_LIST_REMOVE_AT", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->removeAt(args[1_uz].value<usize>());
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_CLEAR"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
+    registerNative("__NATIVE_LIST_CLEAR", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             args[0_uz].object()->asList()->clear();
             return Value::none();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_REPEAT"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Int);
+    registerNative("__NATIVE_LIST_REPEAT", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Int)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->repeat(args[1_uz].value<isize>());
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_LIST_CONCAT"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::List);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::List);
+    registerNative("__NATIVE_LIST_CONCAT", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::List)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asList()->concat(*args[1_uz].object()->asList());
         }});
 }
 
 auto Vm::registerSetNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_INSERT"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_INSERT", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asSet()->tryInsert(std::move(args[1_uz]));
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_CONTAINS"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_CONTAINS", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asSet()->contains(args[1_uz]);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_REMOVE"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_REMOVE", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asSet()->remove(args[1_uz]);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_IS_SUBSET"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_IS_SUBSET", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             const auto a = args[0_uz].object()->asSet();
             const auto b = args[1_uz].object()->asSet();
             return a->isSubset(*b);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_IS_SUPERSET"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_IS_SUPERSET", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             const auto a = args[0_uz].object()->asSet();
             const auto b = args[1_uz].object()->asSet();
             return a->isSuperset(*b);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_UNION"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_UNION", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             const auto a = args[0_uz].object()->asSet();
             const auto b = args[1_uz].object()->asSet();
             return a->unionWith(*b);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_INTERSECTION"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_INTERSECTION", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             const auto a = args[0_uz].object()->asSet();
             const auto b = args[1_uz].object()->asSet();
             return a->intersection(*b);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_DIFFERENCE"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_DIFFERENCE", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             const auto a = args[0_uz].object()->asSet();
             const auto b = args[1_uz].object()->asSet();
             return a->difference(*b);
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_SET_SYMMETRIC_DIFFERENCE"), NativeFunction{
-        2_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Set);
-            throwIfWrongType(1_uz, args[1_uz], types::Type::Set);
+    registerNative("__NATIVE_SET_SYMMETRIC_DIFFERENCE", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = wrongTypeError(1_uz, args[1_uz], types::Type::Set)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             const auto a = args[0_uz].object()->asSet();
             const auto b = args[1_uz].object()->asSet();
             return a->symmetricDifference(*b);
@@ -274,44 +397,109 @@ auto Vm::registerSetNatives() noexcept -> void
 
 auto Vm::registerRangeNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_RANGE_IS_INFINITE_LOOP"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Range);
+    registerNative("__NATIVE_RANGE_CONTAINS", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Range)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
+            return args[0_uz].object()->asRange()->contains(args[1_uz]);
+        }});
+
+    registerNative("__NATIVE_RANGE_IS_INFINITE_LOOP", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Range)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asRange()->isInfiniteLoop();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_RANGE_START"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Range);
+    registerNative("__NATIVE_RANGE_START", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Range)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asRange()->rangeStart();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_RANGE_END"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Range);
+    registerNative("__NATIVE_RANGE_END", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Range)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asRange()->rangeEnd();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_RANGE_INCREMENT"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Range);
+    registerNative("__NATIVE_RANGE_INCREMENT", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Range)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asRange()->rangeIncrement();
         }});
 
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_RANGE_INCLUSIVE"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::Range);
+    registerNative("__NATIVE_RANGE_INCLUSIVE", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::Range)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].object()->asRange()->rangeInclusive();
         }});
 }
 
 auto Vm::registerStringNatives() noexcept -> void
 {
-    m_nativeFunctionLookup.emplace(m_nativeNameHasher("__NATIVE_STRING_LENGTH"), NativeFunction{
-        1_u8, [](std::span<Value> args) -> Value {
-            throwIfWrongType(0_uz, args[0_uz], types::Type::String);
+    registerNative("__NATIVE_STRING_LENGTH", NativeFunction{
+        1_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::String)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
             return args[0_uz].string().size();
         }});
+
+    registerNative("__NATIVE_STRING_JOIN", NativeFunction{
+        2_u8, [](std::span<Value> args) -> Result<Value> {
+            if (auto typeError = wrongTypeError(0_uz, args[0_uz], types::Type::String)) {
+                return std::unexpected{std::move(*typeError)};
+            }
+            if (auto typeError = notIterableError(1_uz, args[1_uz])) {
+                return std::unexpected{std::move(*typeError)};
+            }
+
+            // unpack leaves the number of values on the end
+            std::vector<Value> values;
+            args[1_uz].object()->asIterable()->unpack(values);
+            values.pop_back();
+
+            const auto separator = args[0_uz].string();
+            auto size = values.empty() ? 0_uz : separator.size() * (values.size() - 1_uz);
+            for (auto& value : values) {
+                if (value.type() != types::Type::String) {
+                    value = value.toString();
+                }
+
+                size += value.string().size();
+            }
+
+            // the size is known up front, so the result is only allocated once
+            std::string res;
+            res.reserve(size);
+            for (auto i = 0_uz; i < values.size(); i++) {
+                if (i > 0_uz) {
+                    res.append(separator);
+                }
+
+                res.append(values[i].string());
+            }
+
+            return res;
+        }});
 }
 }   // namespace poise::runtime
 
@@ -3,6 +3,9 @@
 #include <fmt/core.h>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <iterator>
+
 #ifdef POISE_DEBUG
 #include <chrono>
 #endif
@@ -13,22 +16,19 @@ using namespace objects;
 
 auto Gc::initialise() noexcept -> void
 {
-    m_trackedObjects.clear();
+    m_youngObjects.clear();
+    m_oldObjects.clear();
+    m_rememberedObjects.clear();
     m_roots.clear();
-    m_totalAllocatedObjects = 0_uz;
-    m_nextCleanCycles = 8_uz;
+    m_nextMajorCollection = s_initialMajorCollection;
 }
 
 auto Gc::trackObject(Object* object) noexcept -> void
 {
-#ifdef __cpp_lib_ranges_contains
-    POISE_ASSERT(!ranges::contains(m_trackedObjects, object), fmt::format("Already tracking object {} {} at {}", object->type(), object->toString(), fmt::ptr(object)));
-#else
-    POISE_ASSERT(!m_trackedObjects.contains(object), fmt::format("Already tracking object {} {} at {}", object->type(), object->toString(), fmt::ptr(object)));
-#endif
+    POISE_ASSERT(!m_youngObjects.contains(object) && !m_oldObjects.contains(object), fmt::format("Already tracking object {} {} at {}", object->type(), object->toString(), fmt::ptr(object)));
 
-    m_trackedObjects.insert(object);
-    m_totalAllocatedObjects++;
+    m_youngObjects.insert(object);
+    object->setYoung(true);
 }
 
 auto Gc::stopTrackingObject(Object* object) noexcept -> void
@@ -37,28 +37,41 @@ auto Gc::stopTrackingObject(Object* object) noexcept -> void
         return;
     }
 
-#ifdef __cpp_lib_ranges_contains
-    POISE_ASSERT(ranges::contains(m_trackedObjects, object), fmt::format("Not tracking {} {} at {}", object->type(), object->toString(), fmt::ptr(object)));
-#else
-    POISE_ASSERT(m_trackedObjects.contains(object), fmt::format("Not tracking {} {} at {}", object->type(), object->toString(), fmt::ptr(object)));
-#endif
+    auto& generation = object->young() ? m_youngObjects : m_oldObjects;
+    POISE_ASSERT(generation.contains(object), fmt::format("Not tracking {} {} at {}", object->type(), object->toString(), fmt::ptr(object)));
+    generation.erase(object);
 
-    m_trackedObjects.erase(object);
+    if (object->remembered()) {
+        m_rememberedObjects.erase(object);
+        object->setRemembered(false);
+    }
 }
 
 auto Gc::markRoot(Object* root) noexcept -> void
 {
-    m_roots.insert(root);
+    m_roots.push_back(root);
+}
+
+auto Gc::rememberObject(Object* object) noexcept -> void
+{
+    if (!object->tracking() || object->remembered()) {
+        return;
+    }
+
+    m_rememberedObjects.insert(object);
+    object->setRemembered(true);
 }
 
 auto Gc::finalise() noexcept -> void
 {
-    cleanCycles();
+    collectAll();
 
 #ifdef POISE_DEBUG
-    if (!m_trackedObjects.empty()) {
-        for (auto object : m_trackedObjects) {
-            fmt::print(stderr, "{} {} at {} is still being tracked with {} references\n", object->type(), object->toString(), fmt::ptr(object), object->refCount());
+    if (numTrackedObjects() != 0_uz) {
+        for (const auto generation : {&m_youngObjects, &m_oldObjects}) {
+            for (auto object : *generation) {
+                fmt::print(stderr, "{} {} at {} is still being tracked with {} references\n", object->type(), object->toString(), fmt::ptr(object), object->refCount());
+            }
         }
 
         POISE_ASSERT(false, "Objects were still being tracked at shutdown");
@@ -68,43 +81,137 @@ auto Gc::finalise() noexcept -> void
 
 auto Gc::numTrackedObjects() const noexcept -> usize
 {
-    return m_trackedObjects.size();
+    return m_youngObjects.size() + m_oldObjects.size();
+}
+
+auto Gc::numYoungObjects() const noexcept -> usize
+{
+    return m_youngObjects.size();
+}
+
+auto Gc::numRememberedObjects() const noexcept -> usize
+{
+    return m_rememberedObjects.size();
 }
 
 auto Gc::shouldCleanCycles() const noexcept -> bool
 {
-    return m_totalAllocatedObjects > m_nextCleanCycles;
+    // objects freed by reference counting leave the nursery straight away, so this only fills up with survivors
+    return m_youngObjects.size() >= s_nurseryCapacity;
 }
 
 auto Gc::cleanCycles() noexcept -> void
+{
+    if (numTrackedObjects() >= m_nextMajorCollection) {
+        collectAll();
+    } else {
+        collectNursery();
+    }
+}
+
+auto Gc::collectNursery() noexcept -> void
+{
+    collect(Collection::Minor);
+}
+
+auto Gc::collectAll() noexcept -> void
+{
+    collect(Collection::Major);
+    m_nextMajorCollection = std::max(s_initialMajorCollection, numTrackedObjects() * 2_uz);
+}
+
+auto Gc::collect(Collection collection) noexcept -> void
 {
 #ifdef POISE_DEBUG
-    fmt::print("CLEANING CYCLES\n");
+    fmt::print("CLEANING CYCLES ({})\n", collection == Collection::Minor ? "minor" : "major");
     const auto start = std::chrono::steady_clock::now();
-    auto numObjectsDeleted = 0_uz;
 #endif
 
-    m_nextCleanCycles *= 2_uz;
-
     // roots have been marked (the stack, iterators, and local variables)
     // so find every object reachable from these roots
-    std::unordered_set<Object*> reachableObjects;
-    for (const auto object : m_roots) {
-        if (const auto [it, inserted] = reachableObjects.insert(object); inserted) {
-            object->findObjectMembers(reachableObjects);
+    mark(collection);
+
+    // anything that's not reachable needs to be deleted, a minor collection only looks at the nursery
+    std::vector<Object*> unreachableObjects;
+    findUnreachable(m_youngObjects, unreachableObjects);
+    if (collection == Collection::Major) {
+        findUnreachable(m_oldObjects, unreachableObjects);
+    }
+
+    // clear the marks before anything is deleted, removing members below can delete reachable objects
+    // that were only held by unreachable ones, and they can't be touched after that
+    for (const auto object : m_markedObjects) {
+        object->setMarked(false);
+    }
+
+    m_markedObjects.clear();
+
+    deleteObjects(unreachableObjects);
+
+    // everything left in the nursery is reachable, so it doesn't need to be looked at by minor collections any more
+    promoteNursery();
+    forgetRememberedObjects();
+
+    // clear roots for the next collection
+    m_roots.clear();
+
+#ifdef POISE_DEBUG
+    const auto end = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    fmt::print("Deleted {} objects in {} ms\n", unreachableObjects.size(), duration);
+#endif
+}
+
+auto Gc::mark(Collection collection) noexcept -> void
+{
+    m_workList.clear();
+    m_markedObjects.clear();
+
+    if (collection == Collection::Major) {
+        m_workList.insert(m_workList.end(), m_roots.begin(), m_roots.end());
+    } else {
+        // old objects can't be collected by a minor collection, so only young objects are visited,
+        // the old objects that could be holding young ones have been remembered
+        ranges::copy_if(m_roots, std::back_inserter(m_workList), [] (const Object* root) -> bool {
+            return root->young();
+        });
+
+        for (const auto object : m_rememberedObjects) {
+            if (object->young()) {
+                m_workList.push_back(object);
+            } else {
+                object->findObjectMembers(m_workList);
+            }
+        }
+    }
+
+    while (!m_workList.empty()) {
+        const auto object = m_workList.back();
+        m_workList.pop_back();
+
+        if (object->marked() || (collection == Collection::Minor && !object->young())) {
+            continue;
         }
+
+        object->setMarked(true);
+        m_markedObjects.push_back(object);
+        object->findObjectMembers(m_workList);
     }
+}
 
-    // anything that's not reachable needs to be deleted
-    std::unordered_set<Object*> unreachableObjects;
-    for (const auto object : m_trackedObjects) {
-        if (!reachableObjects.contains(object)) {
+auto Gc::findUnreachable(const std::unordered_set<Object*>& generation, std::vector<Object*>& unreachableObjects) noexcept -> void
+{
+    for (const auto object : generation) {
+        if (!object->marked()) {
             // give them an extra reference to make sure they don't get deleted indirectly
             object->incrementRefCount();
-            unreachableObjects.insert(object);
+            unreachableObjects.push_back(object);
         }
     }
+}
 
+auto Gc::deleteObjects(const std::vector<Object*>& unreachableObjects) noexcept -> void
+{
     for (const auto object : unreachableObjects) {
         // disable tracking and remove them from our lists here
         stopTrackingObject(object);
@@ -117,18 +224,27 @@ auto Gc::cleanCycles() noexcept -> void
     for (const auto object : unreachableObjects) {
 #ifdef POISE_DEBUG
         fmt::print("Deleting unreachable {} at {}\n", object->type(), fmt::ptr(object));
-        numObjectsDeleted++;
 #endif
         delete object;
     }
+}
 
-    // clear roots for the next call to cleanCycles()
-    m_roots.clear();
+auto Gc::promoteNursery() noexcept -> void
+{
+    for (const auto object : m_youngObjects) {
+        object->setYoung(false);
+    }
 
-#ifdef POISE_DEBUG
-    const auto end = std::chrono::steady_clock::now();
-    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    fmt::print("Deleted {} objects in {} ms\n", numObjectsDeleted, duration);
-#endif
+    m_oldObjects.merge(m_youngObjects);
+    m_youngObjects.clear();
+}
+
+auto Gc::forgetRememberedObjects() noexcept -> void
+{
+    for (const auto object : m_rememberedObjects) {
+        object->setRemembered(false);
+    }
+
+    m_rememberedObjects.clear();
 }
 } // namespace poise::runtime::memory
@@ -5,6 +5,7 @@
 #include "../../objects/Object.hpp"
 
 #include <unordered_set>
+#include <vector>
 
 namespace poise::runtime::memory {
 class Gc
@@ -24,23 +25,53 @@ public:
     auto trackObject(objects::Object* object) noexcept -> void;
     auto stopTrackingObject(objects::Object* object) noexcept -> void;
     auto markRoot(objects::Object* root) noexcept -> void;
+    auto rememberObject(objects::Object* object) noexcept -> void;
     auto finalise() noexcept -> void;
 
     [[nodiscard]] auto numTrackedObjects() const noexcept -> usize;
+    [[nodiscard]] auto numYoungObjects() const noexcept -> usize;
+    [[nodiscard]] auto numRememberedObjects() const noexcept -> usize;
     [[nodiscard]] auto shouldCleanCycles() const noexcept -> bool;
     auto cleanCycles() noexcept -> void;
+    auto collectNursery() noexcept -> void;
+    auto collectAll() noexcept -> void;
 
 private:
     Gc() = default;
 
-    usize m_totalAllocatedObjects = 0_uz;
-    usize m_nextCleanCycles = 8_uz;
+    enum class Collection
+    {
+        Minor,
+        Major,
+    };
+
+    auto collect(Collection collection) noexcept -> void;
+    auto mark(Collection collection) noexcept -> void;
+    auto findUnreachable(const std::unordered_set<objects::Object*>& generation, std::vector<objects::Object*>& unreachableObjects) noexcept -> void;
+    auto deleteObjects(const std::vector<objects::Object*>& unreachableObjects) noexcept -> void;
+    auto promoteNursery() noexcept -> void;
+    auto forgetRememberedObjects() noexcept -> void;
+
+    static constexpr usize s_nurseryCapacity = 1024_uz;
+    static constexpr usize s_initialMajorCollection = 8_uz * s_nurseryCapacity;
+
+    usize m_nextMajorCollection = s_initialMajorCollection;
 
-    std::unordered_set<objects::Object*> m_roots;
-    std::unordered_set<objects::Object*> m_trackedObjects;
+    std::vector<objects::Object*> m_roots;
+
+    // new objects start in the nursery, and are promoted to the old generation once they survive a collection
+    std::unordered_set<objects::Object*> m_youngObjects;
+    std::unordered_set<objects::Object*> m_oldObjects;
+
+    // old objects that have had a young object stored in them, and young objects that escaped somewhere
+    // the Gc can't see, since the last collection
+    std::unordered_set<objects::Object*> m_rememberedObjects;
+
+    // kept between collections to avoid reallocating
+    std::vector<objects::Object*> m_workList;
+    std::vector<objects::Object*> m_markedObjects;
 };
 } // namespace poise::runtime::memory
 
 
 #endif // #ifndef POISE_GC_HPP
-
@@ -0,0 +1,103 @@
+#include "SharedString.hpp"
+#include "StringInterner.hpp"
+
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace poise::runtime::memory {
+SharedString::SharedString(usize size, usize hash, const char* chars) noexcept
+    : m_size{size}
+    , m_hash{hash}
+    , m_chars{chars}
+{
+
+}
+
+auto SharedString::create(std::string_view string) -> SharedString*
+{
+    auto memory = ::operator new(sizeof(SharedString) + string.size());
+    const auto chars = static_cast<char*>(memory) + sizeof(SharedString);
+    std::memcpy(chars, string.data(), string.size());
+    return new (memory) SharedString{string.size(), std::hash<std::string_view>{}(string), chars};
+}
+
+auto SharedString::concatenate(SharedString* left, SharedString* right) -> SharedString*
+{
+    auto sharedString = new (::operator new(sizeof(SharedString))) SharedString{left->size() + right->size(), 0_uz, nullptr};
+    sharedString->m_left = left;
+    sharedString->m_right = right;
+    return sharedString;
+}
+
+auto SharedString::release() noexcept -> void
+{
+    if (--m_refCount == 0_uz) {
+        destroy(this);
+    }
+}
+
+auto SharedString::flatten() const noexcept -> void
+{
+    const auto buffer = new char[m_size];
+    auto out = buffer;
+
+    // strings built in a loop are deeply nested on the left, so walk them without recursing
+    std::vector<const SharedString*> pending{m_right, m_left};
+    while (!pending.empty()) {
+        const auto string = pending.back();
+        pending.pop_back();
+
+        if (string->m_chars == nullptr) {
+            pending.push_back(string->m_right);
+            pending.push_back(string->m_left);
+        } else {
+            std::memcpy(out, string->m_chars, string->m_size);
+            out += string->m_size;
+        }
+    }
+
+    m_chars = buffer;
+    m_hash = std::hash<std::string_view>{}({buffer, m_size});
+    std::exchange(m_left, nullptr)->release();
+    std::exchange(m_right, nullptr)->release();
+}
+
+auto SharedString::destroy(SharedString* string) noexcept -> void
+{
+    const auto free = [] (SharedString* dead) {
+        if (dead->m_interned) {
+            forgetInternedString(dead);
+        }
+
+        if (dead->m_chars != dead->inlineChars()) {
+            delete[] dead->m_chars;
+        }
+
+        dead->~SharedString();
+        ::operator delete(dead);
+    };
+
+    if (string->m_left == nullptr) {
+        free(string);
+        return;
+    }
+
+    // as with flattening, releasing the halves of a deeply nested concatenation mustn't recurse
+    std::vector<SharedString*> pending{string};
+    while (!pending.empty()) {
+        const auto dead = pending.back();
+        pending.pop_back();
+
+        for (const auto half : {dead->m_left, dead->m_right}) {
+            if (half != nullptr && --half->m_refCount == 0_uz) {
+                pending.push_back(half);
+            }
+        }
+
+        free(dead);
+    }
+}
+} // namespace poise::runtime::memory
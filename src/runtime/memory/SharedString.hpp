@@ -0,0 +1,100 @@
+#ifndef POISE_SHARED_STRING_HPP
+#define POISE_SHARED_STRING_HPP
+
+#include "../../Poise.hpp"
+
+#include <string_view>
+
+namespace poise::runtime::memory {
+/*
+    an immutable string that every Value copied from the one that created it points to,
+    the characters are allocated in the same block as the reference count, size and hash
+
+    a concatenation holds references to its two halves and only copies their characters into a buffer
+    of its own the first time they're read, so building a string up piece by piece copies each piece once
+*/
+class SharedString
+{
+public:
+    SharedString(const SharedString&) = delete;
+    SharedString& operator=(const SharedString&) = delete;
+
+    // the new string has a reference count of 1
+    [[nodiscard]] static auto create(std::string_view string) -> SharedString*;
+    // takes over the caller's references to left and right
+    [[nodiscard]] static auto concatenate(SharedString* left, SharedString* right) -> SharedString*;
+
+    auto retain() noexcept -> void
+    {
+        m_refCount++;
+    }
+
+    // frees the string when the last reference is released
+    auto release() noexcept -> void;
+
+    [[nodiscard]] auto view() const noexcept -> std::string_view
+    {
+        if (m_chars == nullptr) {
+            flatten();
+        }
+
+        return {m_chars, m_size};
+    }
+
+    [[nodiscard]] auto size() const noexcept -> usize
+    {
+        return m_size;
+    }
+
+    [[nodiscard]] auto hash() const noexcept -> usize
+    {
+        if (m_chars == nullptr) {
+            flatten();
+        }
+
+        return m_hash;
+    }
+
+    [[nodiscard]] auto refCount() const noexcept -> usize
+    {
+        return m_refCount;
+    }
+
+    // interned strings remove themselves from the interner when their last reference is released,
+    // and no two interned strings have the same characters
+    auto setInterned(bool interned) noexcept -> void
+    {
+        m_interned = interned;
+    }
+
+    [[nodiscard]] auto interned() const noexcept -> bool
+    {
+        return m_interned;
+    }
+
+private:
+    SharedString(usize size, usize hash, const char* chars) noexcept;
+    ~SharedString() = default;
+
+    [[nodiscard]] auto inlineChars() const noexcept -> const char*
+    {
+        return reinterpret_cast<const char*>(this + 1);
+    }
+
+    // copies the characters of a concatenation into its own buffer and drops its halves
+    auto flatten() const noexcept -> void;
+    // frees the string, and any halves of a concatenation that aren't referenced by anything else
+    static auto destroy(SharedString* string) noexcept -> void;
+
+    usize m_refCount = 1_uz;
+    usize m_size;
+    mutable usize m_hash;
+    // nullptr until a concatenation has been flattened
+    mutable const char* m_chars;
+    mutable SharedString* m_left{};
+    mutable SharedString* m_right{};
+    bool m_interned{};
+};
+} // namespace poise::runtime::memory
+
+#endif // #ifndef POISE_SHARED_STRING_HPP
@@ -1,29 +1,123 @@
 #include "StringInterner.hpp"
+#include "SharedString.hpp"
 #include "../../utils/DualIndexSet.hpp"
 
 #include <fmt/core.h>
 
+#include <functional>
+#include <vector>
+
 namespace poise::runtime::memory {
-static utils::DualIndexSet<std::string> s_stringPool;
+namespace {
+struct InternedString
+{
+    SharedString* string{};
+    // the interner holds a reference of its own to strings interned with internString()
+    bool pinned{};
+};
+
+struct InternedStringHash
+{
+    [[nodiscard]] auto operator()(const InternedString& interned) const noexcept -> usize
+    {
+        return interned.string->hash();
+    }
+};
+} // namespace
+
+static utils::DualIndexSet<InternedString, InternedStringHash> s_stringPool;
+
+// the pinned strings are released at exit, this is declared after the pool so it's destroyed before it
+static const struct StringPoolReleaser
+{
+    ~StringPoolReleaser()
+    {
+        intialiseStringInterning();
+    }
+} s_stringPoolReleaser;
 
 auto intialiseStringInterning() noexcept -> void
 {
+    // anything still referenced after this is an ordinary string, so it can't be mistaken for a newly interned one
+    std::vector<SharedString*> pinned;
+    s_stringPool.forEach([&pinned] (const InternedString& interned) {
+        interned.string->setInterned(false);
+        if (interned.pinned) {
+            pinned.push_back(interned.string);
+        }
+    });
+
     s_stringPool.clear();
+    for (const auto string : pinned) {
+        string->release();
+    }
 }
 
-auto internString(std::string string) noexcept -> usize
+auto internString(std::string_view string) noexcept -> usize
 {
-    return s_stringPool.insert(std::move(string)).hash;
+    const auto hash = std::hash<std::string_view>{}(string);
+    if (s_stringPool.contains(hash)) {
+        if (auto& interned = s_stringPool.find(hash); !interned.pinned) {
+            interned.pinned = true;
+            interned.string->retain();
+        }
+    } else {
+        auto sharedString = SharedString::create(string);
+        sharedString->setInterned(true);
+        s_stringPool.insert({.string = sharedString, .pinned = true});
+    }
+
+    return hash;
 }
 
-auto removeInternedString(const std::string& string) noexcept -> bool
+auto internSharedString(std::string_view string) noexcept -> SharedString*
 {
-    return s_stringPool.remove(string);
+    const auto hash = std::hash<std::string_view>{}(string);
+    if (s_stringPool.contains(hash)) {
+        const auto interned = s_stringPool.find(hash).string;
+
+        // a different string with the same hash is left uninterned rather than taking the other's place
+        if (interned->view() != string) {
+            return SharedString::create(string);
+        }
+
+        interned->retain();
+        return interned;
+    }
+
+    auto sharedString = SharedString::create(string);
+    sharedString->setInterned(true);
+    s_stringPool.insert({.string = sharedString, .pinned = false});
+    return sharedString;
+}
+
+auto forgetInternedString(const SharedString* string) noexcept -> void
+{
+    if (s_stringPool.contains(string->hash()) && s_stringPool.find(string->hash()).string == string) {
+        [[maybe_unused]] const auto removed = s_stringPool.remove(string->hash());
+    }
+}
+
+auto removeInternedString(std::string_view string) noexcept -> bool
+{
+    return removeInternedStringId(std::hash<std::string_view>{}(string));
 }
 
 auto removeInternedStringId(usize hash) noexcept -> bool
 {
-    return s_stringPool.remove(hash);
+    if (!s_stringPool.contains(hash)) {
+        return false;
+    }
+
+    auto& interned = s_stringPool.find(hash);
+    if (!interned.pinned) {
+        return false;
+    }
+
+    // releasing it might remove it from the pool, so don't touch the entry after
+    interned.pinned = false;
+    interned.string->release();
+    return true;
 }
 
 auto internedStringCount() noexcept -> usize
@@ -31,14 +125,16 @@ auto internedStringCount() noexcept -> usize
     return s_stringPool.size();
 }
 
-auto findInternedString(usize hash) noexcept -> const std::string&
+auto findInternedString(usize hash) noexcept -> std::string_view
 {
-    return s_stringPool.find(hash);
+    return s_stringPool.find(hash).string->view();
 }
 
 auto dumpStrings() noexcept -> void
 {
-    s_stringPool.dump();
+    fmt::print("Contents of string pool:\n");
+    s_stringPool.forEach([] (const InternedString& interned) {
+        fmt::print("\t{} ({} references{})\n", interned.string->view(), interned.string->refCount(), interned.pinned ? ", pinned" : "");
+    });
 }
 } // namespace poise::runtime::memory
-
@@ -3,20 +3,27 @@
 
 #include "../../Poise.hpp"
 
-#include <string>
+#include <string_view>
 
 namespace poise::runtime::memory {
+class SharedString;
+
 auto intialiseStringInterning() noexcept -> void;
 
-[[nodiscard]] auto internString(std::string string) noexcept -> usize;
-[[nodiscard]] auto removeInternedString(const std::string& string) noexcept -> bool;
+// interns the string until it's removed, returning its id, for names the compiler looks things up by
+[[nodiscard]] auto internString(std::string_view string) noexcept -> usize;
+// a new reference to the interned copy of the string, which is only interned while there are references to it
+[[nodiscard]] auto internSharedString(std::string_view string) noexcept -> SharedString*;
+// called by an interned SharedString when its last reference is released
+auto forgetInternedString(const SharedString* string) noexcept -> void;
+// these undo internString, the string stays interned while anything else holds a reference to it
+[[nodiscard]] auto removeInternedString(std::string_view string) noexcept -> bool;
 [[nodiscard]] auto removeInternedStringId(usize hash) noexcept -> bool;
 
 [[nodiscard]] auto internedStringCount() noexcept -> usize;
-[[nodiscard]] auto findInternedString(usize hash) noexcept -> const std::string&;
+[[nodiscard]] auto findInternedString(usize hash) noexcept -> std::string_view;
 
 auto dumpStrings() noexcept -> void;
 } // namespace poise::runtime::memory
 
 #endif // #ifndef STRING_INTERNER_HPP
-
@@ -99,14 +99,16 @@ public:
             auto& entry = m_data[index];
 
             if (entry.hash == hash) {
-                entry = Entry{};
-
-                index++;
-                while (m_data[index].occupied && m_data[index].distance > 0_uz) {
-                    std::swap(entry, m_data[index]);
-                    index = (index + 1_uz) % m_capacity;
+                // shift the following entries back into the gap until one is already where it wants to be
+                auto next = (index + 1_uz) % m_capacity;
+                while (m_data[next].occupied && m_data[next].distance > 0_uz) {
+                    m_data[index] = std::move(m_data[next]);
+                    m_data[index].distance--;
+                    index = next;
+                    next = (next + 1_uz) % m_capacity;
                 }
 
+                m_data[index] = Entry{};
                 m_size--;
                 return true;
             }
@@ -183,6 +185,16 @@ public:
         return m_size == 0_uz;
     }
 
+    template<typename Function>
+    auto forEach(Function function) const noexcept -> void
+    {
+        for (const auto& entry : m_data) {
+            if (entry.occupied) {
+                function(entry.value);
+            }
+        }
+    }
+
     auto dump() const noexcept -> void requires(fmt::is_formattable<ValueType>::value)
     {
         fmt::print("Contents of DualIndexSet:\n");
@@ -3,9 +3,11 @@
 #include "../src/runtime/memory/Gc.hpp"
 #include "../src/runtime/memory/StringInterner.hpp"
 #include "../src/runtime/Value.hpp"
+#include "../src/runtime/Vm.hpp"
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -21,7 +23,11 @@ TEST_CASE("Basic Reference Counting", "[memory]")
     const auto exception = Value::createObject<Exception>("Test");
 
     {
-        function.object()->asFunction()->addCapture(exception);
+        function.object()->asFunction()->addUpvalue(std::make_shared<Function::Upvalue>(Function::Upvalue{
+            .slot = 0_uz,
+            .isOpen = false,
+            .value = exception,
+        }));
         const auto functionCopy = function;
         const auto exceptionCopy = exception;
     }
@@ -29,6 +35,46 @@ TEST_CASE("Basic Reference Counting", "[memory]")
     REQUIRE((function.object()->refCount() == 1_uz && exception.object()->refCount() == 2_uz));
 }
 
+TEST_CASE("Collected Closures Leave Shared Upvalues", "[memory]")
+{
+    using namespace poise::objects;
+    using namespace poise::objects::iterables;
+    using namespace poise::runtime;
+    using namespace poise::runtime::memory;
+
+    REINITIALISE();
+
+    auto makeUpvalue = [] (Value value) {
+        return std::make_shared<Function::Upvalue>(Function::Upvalue{
+            .slot = 0_uz,
+            .isOpen = false,
+            .value = std::move(value),
+        });
+    };
+
+    // a captures cfg and a box holding a, b only captures cfg
+    const auto cfg = makeUpvalue(Value::createObject<List>(std::vector<Value>{42_i64}));
+    const auto b = Value::createObject<Function>("b", "", 0_uz, 0_u8, false, false);
+    b.object()->asFunction()->addUpvalue(cfg);
+
+    {
+        const auto a = Value::createObject<Function>("a", "", 0_uz, 0_u8, false, false);
+        const auto box = Value::createObject<List>(std::vector<Value>{a});
+        a.object()->asFunction()->addUpvalue(cfg);
+        a.object()->asFunction()->addUpvalue(makeUpvalue(box));
+    }
+
+    Gc::instance().markRoot(b.object());
+    Gc::instance().collectAll();
+
+    // only b and the list it captured are left, and b can still see the list
+    REQUIRE(Gc::instance().numTrackedObjects() == 2_uz);
+    REQUIRE(cfg.use_count() == 2);
+    const auto& captured = b.object()->asFunction()->upvalue(0_uz)->value;
+    REQUIRE(captured.type() == types::Type::List);
+    REQUIRE(captured.object()->asList()->at(0_iz) == Value{42_i64});
+}
+
 TEST_CASE("Cyclic Reference Countring", "[memory]")
 {
     using namespace poise::objects;
@@ -60,6 +106,110 @@ TEST_CASE("Cyclic Reference Countring", "[memory]")
     REQUIRE(Gc::instance().numTrackedObjects() == 0_uz);
 }
 
+TEST_CASE("Generational Collection", "[memory]")
+{
+    using namespace poise::objects;
+    using namespace poise::objects::iterables;
+    using namespace poise::runtime;
+    using namespace poise::runtime::memory;
+
+    REINITIALISE();
+
+    auto makeCycle = [] {
+        auto list = Value::createObject<List>(std::vector<Value>{});
+        list.object()->asList()->append(list);
+        return list;
+    };
+
+    auto cache = Value::createObject<List>(std::vector<Value>{});
+
+    // surviving a collection promotes an object out of the nursery
+    Gc::instance().markRoot(cache.object());
+    Gc::instance().collectNursery();
+    REQUIRE(Gc::instance().numTrackedObjects() == 1_uz);
+    REQUIRE(Gc::instance().numYoungObjects() == 0_uz);
+
+    // storing a young object in an old one remembers the old one
+    cache.object()->asList()->append(makeCycle());
+    makeCycle();
+    REQUIRE(Gc::instance().numYoungObjects() == 2_uz);
+    REQUIRE(Gc::instance().numRememberedObjects() == 1_uz);
+
+    // so a minor collection keeps what it holds without scanning it as a root, and frees the garbage
+    Gc::instance().markRoot(cache.object());
+    Gc::instance().collectNursery();
+    REQUIRE(Gc::instance().numTrackedObjects() == 2_uz);
+    REQUIRE(Gc::instance().numYoungObjects() == 0_uz);
+    REQUIRE(Gc::instance().numRememberedObjects() == 0_uz);
+
+    // old garbage is left for a major collection
+    cache.object()->asList()->clear();
+    Gc::instance().markRoot(cache.object());
+    Gc::instance().collectNursery();
+    REQUIRE(Gc::instance().numTrackedObjects() == 2_uz);
+
+    Gc::instance().markRoot(cache.object());
+    Gc::instance().collectAll();
+    REQUIRE(Gc::instance().numTrackedObjects() == 1_uz);
+
+    cache = Value::none();
+    REQUIRE(Gc::instance().numTrackedObjects() == 0_uz);
+}
+
+TEST_CASE("Op Handlers Release Their Operands", "[memory]")
+{
+    using namespace poise::objects::iterables;
+    using namespace poise::runtime;
+
+    REINITIALISE();
+
+    // untracked so the collection at exit can't hide a reference that was never released
+    const auto list = Value::createObjectUntracked<List>(std::vector<Value>{1_i64});
+
+    {
+        Vm vm{"test"};
+        auto chunk = vm.currentChunk();
+        const auto listConstant = chunk->addConstant(list);
+        const auto noneConstant = chunk->addConstant(Value::none());
+
+        auto loadList = [&] {
+            chunk->emitOp(Op::LoadConstant, 1_uz);
+            chunk->emitOperand(listConstant);
+        };
+
+        // println(list)
+        loadList();
+        chunk->emitOp(Op::Print, 1_uz);
+        chunk->emitOperand(1_u32);
+        chunk->emitOperand(false);
+        chunk->emitOperand(true);
+
+        // list == list
+        loadList();
+        loadList();
+        chunk->emitOp(Op::Equal, 2_uz);
+        chunk->emitOp(Op::Pop, 2_uz);
+
+        // for x in list {}, the local for x goes in the first slot
+        chunk->emitOp(Op::LoadConstant, 3_uz);
+        chunk->emitOperand(noneConstant);
+        loadList();
+        chunk->emitOp(Op::InitIterator, 3_uz);
+        chunk->emitOperand(0_u32);
+        chunk->emitOperand(0_u32);
+        chunk->emitOp(Op::Pop, 3_uz);
+        chunk->emitOp(Op::PopIterator, 3_uz);
+        chunk->emitOp(Op::Pop, 3_uz);
+
+        chunk->emitOp(Op::Exit, 4_uz);
+
+        REQUIRE(vm.run() == Vm::RunResult::Success);
+        REQUIRE(list.object()->refCount() == 2_uz);
+    }
+
+    REQUIRE(list.object()->refCount() == 1_uz);
+}
+
 TEST_CASE("String Interning", "[memory]")
 {
     using namespace poise::runtime::memory;
@@ -92,5 +242,44 @@ TEST_CASE("String Interning", "[memory]")
 
     REQUIRE(internedStringCount() == 6_uz);
 }
-} // namespace poise::tests
 
+TEST_CASE("Interned String Lifetimes", "[memory]")
+{
+    using namespace poise::runtime;
+    using namespace poise::runtime::memory;
+
+    REINITIALISE();
+
+    // strings are only interned while something holds a reference to them
+    const auto first = internSharedString("some_identifier");
+    const auto second = internSharedString("some_identifier");
+    REQUIRE(first == second);
+    REQUIRE(first->refCount() == 2_uz);
+    REQUIRE(internedStringCount() == 1_uz);
+
+    first->release();
+    second->release();
+    REQUIRE(internedStringCount() == 0_uz);
+
+    // strings interned by id stay until they're removed, and then until the last reference is released
+    const auto id = internString("pinned_name");
+    const auto shared = internSharedString("pinned_name");
+    REQUIRE(findInternedString(id) == "pinned_name");
+    REQUIRE(removeInternedStringId(id));
+    REQUIRE(!removeInternedStringId(id));
+    REQUIRE(internedStringCount() == 1_uz);
+    shared->release();
+    REQUIRE(internedStringCount() == 0_uz);
+
+    // values holding interned strings release them when they're destroyed
+    {
+        const auto constant = Value::internedString("a string known when compiling");
+        const auto copy = constant;
+        REQUIRE(copy == constant);
+#ifdef POISE_INTERN_STRINGS
+        REQUIRE(internedStringCount() == 1_uz);
+#endif
+    }
+    REQUIRE(internedStringCount() == 0_uz);
+}
+} // namespace poise::tests
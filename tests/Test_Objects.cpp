@@ -117,6 +117,31 @@ TEST_CASE("Range", "[objects]")
 
         REQUIRE(iterator.isAtEnd());
     }
+
+    {
+        Range range{0, 1'000'000'000, 3, false};
+        REQUIRE(range.size() == 333'333'334_uz);
+        REQUIRE(range.at(333'333'333_uz) == 999'999'999);
+        REQUIRE(range.contains(999'999'999));
+        REQUIRE(!range.contains(1'000'000'000));
+        REQUIRE(!range.contains(4));
+    }
+
+    {
+        Range range{10, 0, -4, false};
+        REQUIRE(range.size() == 3_uz);
+        REQUIRE(range.contains(2));
+
+        Iterator iterator{&range};
+        iterator.increment();
+        iterator.increment();
+
+        REQUIRE(iterator.value() == 2);
+
+        iterator.increment();
+
+        REQUIRE(iterator.isAtEnd());
+    }
 }
 
 TEST_CASE("Tuple", "[objects]") 
@@ -177,12 +202,18 @@ TEST_CASE("Dictionary", "[objects]")
 
     Iterator iterator{&dict};
     REQUIRE(!iterator.isAtEnd());
+    REQUIRE(dict.at(iterator.dictKey()) == iterator.dictValue());
+    REQUIRE(iterator.value().object()->asTuple()->at(0_uz) == iterator.dictKey());
     iterator.increment();
     REQUIRE(!iterator.isAtEnd());
     for (auto i = 0_uz; i < dict.size() - 1_uz; i++) {
         iterator.increment();
     }
     REQUIRE(iterator.isAtEnd());
+
+    REQUIRE(dict.tryInsert("Ryan2", 25));
+    REQUIRE(!dict.tryInsert("Ryan2", 26));
+    REQUIRE(dict.size() == 10_uz);
 }
 
 TEST_CASE("Set", "[objects]") 
@@ -255,6 +286,15 @@ TEST_CASE("Set", "[objects]")
 
     REQUIRE(Set{"RyanRyanRyan"}.size() == 4_uz);
 
+    // inserting and removing reuses deleted slots, rehashing in place rather than growing
+    Set churn;
+    for (auto i = 0_i64; i < 1000_i64; i++) {
+        REQUIRE(churn.tryInsert(i));
+        REQUIRE(churn.remove(i));
+    }
+    REQUIRE(churn.size() == 0_uz);
+    REQUIRE(churn.capacity() == Hashable::s_initialCapacity);
+
     names = {
         "Ryan",
         "Cat",
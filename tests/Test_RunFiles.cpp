@@ -177,5 +177,185 @@ TEST_CASE("017_constants.poise", "[files]")
     REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
     REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
 }
+
+TEST_CASE("018_register_ops.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/018_register_ops.poise"};
+    vm.setRegisterOps(true);
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/018_register_ops.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("019_quickening.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/019_quickening.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/019_quickening.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("020_error_propagation.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/020_error_propagation.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/020_error_propagation.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("021_frames.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/021_frames.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/021_frames.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("022_direct_calls.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/022_direct_calls.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/022_direct_calls.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("023_tail_calls.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/023_tail_calls.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/023_tail_calls.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("024_member_caches.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/024_member_caches.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/024_member_caches.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("025_link_errors.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/025_link_errors.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/025_link_errors.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::CompileError);
+}
+
+TEST_CASE("026_closures.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/026_closures.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/026_closures.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("027_upvalues.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/027_upvalues.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/027_upvalues.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("028_exception_handlers.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/028_exception_handlers.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/028_exception_handlers.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("029_range_loops.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/029_range_loops.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/029_range_loops.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("030_lazy_ranges.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/030_lazy_ranges.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/030_lazy_ranges.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("031_dict_slots.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/031_dict_slots.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/031_dict_slots.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("032_hash_probing.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/032_hash_probing.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/032_hash_probing.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("033_shared_strings.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/033_shared_strings.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/033_shared_strings.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("034_string_building.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/034_string_building.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/034_string_building.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
+
+TEST_CASE("035_function_values.poise", "[files]")
+{
+    REINITIALISE();
+
+    runtime::Vm vm{"tests/test_files/035_function_values.poise"};
+    compiler::Compiler compiler{true, false, &vm, "tests/test_files/035_function_values.poise"};
+    REQUIRE(compiler.compile() == compiler::Compiler::CompileResult::Success);
+    REQUIRE(vm.run() == runtime::Vm::RunResult::Success);
+}
 } // namespace poise::tests
 
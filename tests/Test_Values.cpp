@@ -3,6 +3,9 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <cmath>
+#include <limits>
+
 namespace poise::tests
 {
 TEST_CASE("Binary Operations", "[values]")
@@ -35,5 +38,90 @@ TEST_CASE("Binary Operations", "[values]")
     REQUIRE(str1 + str2 == "HelloWorld");
     REQUIRE(str1 * int2 == "HelloHello");
 }
-} // namespace poise::tests
 
+TEST_CASE("Representation", "[values]")
+{
+    using namespace poise::runtime;
+
+    REINITIALISE();
+
+    // values at the edges of what a NaN-boxed value can hold inline
+    Value big = std::numeric_limits<i64>::max(), small = std::numeric_limits<i64>::min(), negative = -1;
+    REQUIRE(big.value<i64>() == std::numeric_limits<i64>::max());
+    REQUIRE(small.value<i64>() == std::numeric_limits<i64>::min());
+    REQUIRE(negative.value<i64>() == -1);
+    REQUIRE(big.type() == types::Type::Int);
+
+    Value copy = big;
+    big = 0;
+    REQUIRE(copy.value<i64>() == std::numeric_limits<i64>::max());
+    REQUIRE(copy - 1 == std::numeric_limits<i64>::max() - 1);
+
+    Value nan = std::numeric_limits<f64>::quiet_NaN(), infinity = std::numeric_limits<f64>::infinity();
+    REQUIRE(nan.type() == types::Type::Float);
+    REQUIRE(std::isnan(nan.value<f64>()));
+    REQUIRE(infinity.value<f64>() == std::numeric_limits<f64>::infinity());
+    REQUIRE(Value{-0.0}.type() == types::Type::Float);
+
+    Value str = "Hello";
+    Value moved = std::move(str);
+    REQUIRE(moved == "Hello");
+    REQUIRE(moved.type() == types::Type::String);
+}
+
+TEST_CASE("Strings", "[values]")
+{
+    using namespace poise::runtime;
+
+    REINITIALISE();
+
+    // either side of the longest string stored in the value itself
+    for (const std::string text : {"", "a", "abcdefgh", "abcdefghi", "a much longer string than fits in a value"}) {
+        Value value = text;
+        Value copy = value;
+        REQUIRE(copy.string() == text);
+        REQUIRE(copy == value);
+        REQUIRE(copy.hash() == value.hash());
+        REQUIRE(Value{text}.hash() == value.hash());
+
+        value = 0;
+        REQUIRE(copy.string() == text);
+        REQUIRE(copy.type() == types::Type::String);
+
+        Value moved = std::move(copy);
+        REQUIRE(moved.string() == text);
+        REQUIRE(moved.toString() == text);
+    }
+
+    // strings with the same characters are equal whether or not they share their storage
+    Value first = "a much longer string than fits in a value";
+    Value second = std::string{"a much longer string "} + "than fits in a value";
+    REQUIRE(first == second);
+    REQUIRE(first != Value{"a much longer string than fits in a valuE"});
+    REQUIRE(Value{"abcdefgh"} + Value{"i"} == Value{"abcdefghi"});
+
+    // small strings compare and hash as a word, the size tells apart trailing nulls
+    const Value withNull = std::string{"ab\0", 3_uz};
+    REQUIRE(withNull != Value{"ab"});
+    REQUIRE(withNull.hash() != Value{"ab"}.hash());
+    REQUIRE(Value{"ab"}.hash() == Value{std::string{"a"} + "b"}.hash());
+
+    // interned strings with the same characters are the same string, whichever way they were made
+    const auto interned = Value::internedString("an_interned_identifier");
+    REQUIRE(interned == Value{std::string{"an_interned"} + "_identifier"});
+    REQUIRE(interned != Value::internedString("another_interned_identifier"));
+    REQUIRE(interned.hash() == Value{"an_interned_identifier"}.hash());
+
+    // long concatenations are put together when they're read, deep ones are flattened and freed without recursing
+    const Value prefix = std::string(100_uz, 'x');
+    Value built = prefix, unread = prefix;
+    for (auto i = 0; i < 100'000; i++) {
+        built = built + "y";
+        unread = unread + "y";
+    }
+    REQUIRE(built.string().size() == 100'100_uz);
+    REQUIRE(built.string().substr(98_uz, 4_uz) == "xxyy");
+    REQUIRE(prefix.string().size() == 100_uz);
+    REQUIRE(built.hash() == Value{built.string()}.hash());
+}
+} // namespace poise::tests